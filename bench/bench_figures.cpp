@@ -0,0 +1,434 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Aggregate.h"
+#include "Array.h"
+#include "Containment.h"
+#include "FigureLoader.h"
+#include "FigureStore.h"
+#include "FigureVariant.h"
+#include "KdTree.h"
+#include "Overlap.h"
+#include "Ranking.h"
+#include "ReportWriter.h"
+#include "Transform.h"
+#include "Trapezoid.h"
+
+// Прогон: Lab4_bench [количество фигур]
+
+#ifdef LAB4_HAS_TBB
+#include <execution>
+#endif
+
+using Clock = std::chrono::steady_clock;
+
+template <typename F>
+double timeMs(F&& f, int reps = 5) {
+    double best = 1e300;
+    for (int r = 0; r < reps; ++r) {
+        auto start = Clock::now();
+        f();
+        std::chrono::duration<double, std::milli> d = Clock::now() - start;
+        best = std::min(best, d.count());
+    }
+    return best;
+}
+
+// Как timeMs, но перед каждым прогоном вне замера вызывает setup().
+template <typename S, typename F>
+double timeMs(S&& setup, F&& f, int reps = 5) {
+    double best = 1e300;
+    for (int r = 0; r < reps; ++r) {
+        setup();
+        auto start = Clock::now();
+        f();
+        std::chrono::duration<double, std::milli> d = Clock::now() - start;
+        best = std::min(best, d.count());
+    }
+    return best;
+}
+
+void report(const std::string& name, double ms, size_t count, double check) {
+    std::cout << std::left << std::setw(36) << name
+              << std::right << std::setw(10) << std::fixed << std::setprecision(3) << ms << " ms"
+              << std::setw(10) << std::setprecision(1) << count / ms / 1e3 << " M/s"
+              << "   (check " << std::setprecision(4) << check << ")\n";
+}
+
+std::vector<Trapezoid<double>> makeTrapezoids(size_t count) {
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> coord(-1000.0, 1000.0);
+
+    std::vector<Trapezoid<double>> out;
+    out.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        double x = coord(rng), y = coord(rng);
+        out.emplace_back(Point<double>(x, y), Point<double>(x + 4, y),
+                         Point<double>(x + 3, y + 2), Point<double>(x + 1, y + 2));
+    }
+    return out;
+}
+
+void benchTotalArea(const std::vector<Trapezoid<double>>& src) {
+    const size_t count = src.size();
+
+    // Fresh figures have an empty area cache, so every area goes through
+    // the virtual shoelace call.
+    Array<std::shared_ptr<Figure<double>>> poly;
+    auto refill = [&] {
+        poly.clear();
+        for (const auto& t : src)
+            poly.add(std::make_shared<Trapezoid<double>>(t));
+    };
+
+    FigureStore<double, 4> store;
+    store.reserve(count);
+    for (const auto& t : src)
+        store.add(t);
+
+    double a = 0.0;
+    auto sum = [&] {
+        a = 0.0;
+        for (size_t i = 0; i < poly.getSize(); ++i)
+            a += static_cast<double>(*poly[i]);
+    };
+    double ms = timeMs(refill, sum);
+    report("Array<shared_ptr<Figure>> area cold", ms, count, a);
+
+    ms = timeMs(sum);
+    report("Array<shared_ptr<Figure>> area warm", ms, count, a);
+
+    // Area goes through the lazy cache, which synchronises on an atomic:
+    // allowed under par, not under par_unseq.
+    auto area = [](const auto& f) { return static_cast<double>(*f); };
+    ms = timeMs([&] {
+#ifdef LAB4_HAS_TBB
+        a = std::transform_reduce(std::execution::par, poly.begin(), poly.end(), 0.0, std::plus<>{}, area);
+#else
+        a = std::transform_reduce(poly.begin(), poly.end(), 0.0, std::plus<>{}, area);
+#endif
+    });
+    report("transform_reduce over Array (warm)", ms, count, a);
+
+    double c = 0.0;
+    ms = timeMs([&] { c = aggregate(poly).totalArea; });
+    report("aggregate(Array) (warm)", ms, count, c);
+
+    double b = 0.0;
+    ms = timeMs([&] { b = store.totalArea(); });
+    report("FigureStore<double, 4>::totalArea", ms, count, b);
+}
+
+void benchTextIngest(const std::vector<Trapezoid<double>>& src) {
+    std::ostringstream text;
+    text << std::setprecision(10);
+    for (const auto& t : src) {
+        text << "Trapezoid";
+        for (const auto& v : t.points())
+            text << ' ' << v.x() << ' ' << v.y();
+        text << '\n';
+    }
+    const std::string input = text.str();
+    const size_t coords = src.size() * 8;
+
+    size_t a = 0;
+    double ms = timeMs([&] {
+        std::istringstream in(input);
+        Array<FigureVariant<double>> arr;
+        std::string tag;
+        while (in >> tag) {
+            Trapezoid<double> t;
+            in >> t;
+            arr.add(std::move(t));
+        }
+        a = arr.getSize();
+    }, 1);
+    report("operator>> ingest (coords)", ms, coords, double(a));
+
+    size_t b = 0;
+    ms = timeMs([&] {
+        std::istringstream in(input);
+        Array<FigureVariant<double>> arr;
+        arr.reserve(src.size());
+        b = FigureLoader<double>().load(in, arr).figures;
+    }, 1);
+    report("FigureLoader ingest (coords)", ms, coords, double(b));
+}
+
+// Поток, который отбрасывает всё записанное: меряем только форматирование.
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+void benchReport(const std::vector<Trapezoid<double>>& src) {
+    Array<std::shared_ptr<Figure<double>>> poly;
+    poly.reserve(src.size());
+    for (const auto& t : src)
+        poly.add(std::make_shared<Trapezoid<double>>(t));
+
+    NullBuffer nullBuf;
+    std::ostream sink(&nullBuf);
+
+    auto* old = std::cout.rdbuf(&nullBuf);
+    double ms = timeMs([&] { poly.printAll(); }, 1);
+    std::cout.rdbuf(old);
+    report("printAll (iostream)", ms, src.size(), 0.0);
+
+    ms = timeMs([&] {
+        ReportWriter out(sink, ReportFormat::Text, 4, 1 << 20);
+        printAll(poly, out);
+    }, 1);
+    report("printAll (ReportWriter text)", ms, src.size(), 0.0);
+
+    ms = timeMs([&] {
+        ReportWriter out(sink, ReportFormat::Csv, 4, 1 << 20);
+        for (size_t i = 0; i < poly.getSize(); ++i)
+            out.write(i, *poly[i]);
+    }, 1);
+    report("ReportWriter CSV", ms, src.size(), 0.0);
+
+    ms = timeMs([&] {
+        ReportWriter out(sink, ReportFormat::JsonLines, 4, 1 << 20);
+        for (size_t i = 0; i < poly.getSize(); ++i)
+            out.write(i, *poly[i]);
+    }, 1);
+    report("ReportWriter JSON lines", ms, src.size(), 0.0);
+}
+
+void benchContains(const std::vector<Trapezoid<double>>& src) {
+    Pentagon<double> pent({Point<double>(-800, -900), Point<double>(900, -700), Point<double>(950, 400),
+                           Point<double>(0, 950), Point<double>(-950, 300)});
+
+    std::mt19937_64 rng(11);
+    std::uniform_real_distribution<double> coord(-1000.0, 1000.0);
+    std::vector<Point<double>> cloud(src.size());
+    for (auto& p : cloud)
+        p = Point<double>(coord(rng), coord(rng));
+    std::span<const Point<double>> pts(cloud);
+
+    // Много точек против одной фигуры
+    size_t inside = 0;
+    double ms = timeMs([&] {
+        inside = 0;
+        for (const auto& p : cloud)
+            inside += pent.contains(p);
+    });
+    report("contains (scalar, 1 figure)", ms, cloud.size(), inside);
+
+    ms = timeMs([&] {
+        auto flags = containsBatch(pent, pts, 1);
+        inside = std::count(flags.begin(), flags.end(), 1);
+    });
+    report("containsBatch (SIMD, 1 thread)", ms, cloud.size(), inside);
+
+    ms = timeMs([&] {
+        auto flags = containsBatch(pent, pts);
+        inside = std::count(flags.begin(), flags.end(), 1);
+    });
+    report("containsBatch (SIMD, all threads)", ms, cloud.size(), inside);
+
+    // Одна точка против многих фигур
+    FigureStore<double, 4> store;
+    store.reserve(src.size());
+    for (const auto& t : src)
+        store.add(t);
+
+    std::vector<size_t> hits;
+    ms = timeMs([&] {
+        hits.clear();
+        for (size_t i = 0; i < 16; ++i)
+            store.containing(cloud[i], hits);
+    });
+    report("FigureStore::containing (x16)", ms, 16 * src.size(), hits.size());
+
+    // Классификация облака точек
+    Array<Trapezoid<double>> figs;
+    figs.reserve(src.size());
+    for (const auto& t : src)
+        figs.add(t);
+
+    size_t owned = 0;
+    ms = timeMs([&] {
+        auto owner = classifyPoints(figs, pts);
+        owned = cloud.size() - std::count(owner.begin(), owner.end(), noFigure);
+    }, 1);
+    report("classifyPoints (grid, all threads)", ms, cloud.size(), owned);
+}
+
+void benchNearest(const std::vector<Trapezoid<double>>& src) {
+    constexpr size_t k = 10;
+
+    Array<Trapezoid<double>> figs;
+    figs.reserve(src.size());
+    for (const auto& t : src)
+        figs.add(t);
+
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> coord(-1000.0, 1000.0);
+    std::vector<Point<double>> probes(1'000'000);
+    for (auto& p : probes)
+        p = Point<double>(coord(rng), coord(rng));
+
+    // Линейный поиск через distanceTo: только часть проб, иначе слишком долго
+    const size_t bruteProbes = std::clamp<size_t>(100'000'000 / (src.size() + 1), 1, probes.size());
+    double check = 0.0;
+    double ms = timeMs([&] {
+        std::vector<std::pair<double, size_t>> best;
+        for (size_t p = 0; p < bruteProbes; ++p) {
+            best.clear();
+            for (size_t i = 0; i < figs.getSize(); ++i)
+                best.emplace_back(figs[i].center().distanceTo(probes[p]), i);
+            std::partial_sort(best.begin(), best.begin() + std::min(k, best.size()), best.end());
+            check = best.front().first;
+        }
+    }, 1);
+    report("kNN k=10 (linear scan)", ms, bruteProbes, check);
+
+    KdTree<double> tree;
+    ms = timeMs([&] { tree = KdTree<double>::build(figs); }, 1);
+    report("KdTree build", ms, src.size(), 0.0);
+
+    ms = timeMs([&] {
+        auto res = tree.nearest(std::span<const Point<double>>(probes), k, 1);
+        check = res.front().distance;
+    }, 1);
+    report("kNN k=10 (KdTree, 1 thread)", ms, probes.size(), check);
+
+    ms = timeMs([&] {
+        auto res = tree.nearest(std::span<const Point<double>>(probes), k);
+        check = res.front().distance;
+    }, 1);
+    report("kNN k=10 (KdTree, all threads)", ms, probes.size(), check);
+}
+
+void benchOverlap(const std::vector<Trapezoid<double>>& src) {
+    Array<std::shared_ptr<Figure<double>>> poly;
+    poly.reserve(src.size());
+    for (const auto& t : src)
+        poly.add(std::make_shared<Trapezoid<double>>(t));
+
+    size_t pairs = 0;
+    double ms = timeMs([&] { pairs = overlappingPairs(poly, 1).size(); }, 1);
+    report("overlappingPairs (1 thread)", ms, src.size(), pairs);
+
+    ms = timeMs([&] { pairs = overlappingPairs(poly).size(); }, 1);
+    report("overlappingPairs (all threads)", ms, src.size(), pairs);
+}
+
+void benchRanking(const std::vector<Trapezoid<double>>& src) {
+    // Площади разные: растягиваем трапеции по x
+    std::vector<std::shared_ptr<Figure<double>>> shuffled;
+    for (size_t i = 0; i < src.size(); ++i) {
+        auto v = src[i].getVertices();
+        double s = 1.0 + (i * 7919 % 1000) / 100.0;
+        shuffled.push_back(std::make_shared<Trapezoid<double>>(
+            v[0], Point<double>(v[0].x() + 4 * s, v[0].y()), Point<double>(v[0].x() + 3 * s, v[2].y()), v[3]));
+    }
+    auto fill = [&](Array<std::shared_ptr<Figure<double>>>& poly) {
+        poly.clear();
+        for (const auto& f : shuffled)
+            poly.add(f);
+    };
+    Array<std::shared_ptr<Figure<double>>> poly;
+    poly.reserve(src.size());
+
+    // Вручную: копия и сортировка с двумя виртуальными вызовами на сравнение
+    double check = 0.0;
+    double ms = timeMs([&] {
+        auto copy = shuffled;
+        std::sort(copy.begin(), copy.end(), [](const auto& a, const auto& b) { return double(*a) < double(*b); });
+        check = double(*copy.back());
+    }, 1);
+    report("sort copy by area (manual)", ms, src.size(), check);
+
+    fill(poly);
+    ms = timeMs([&] {
+        sortBy(poly, {}, 1);
+        check = double(*poly[poly.getSize() - 1]);
+    }, 1);
+    report("sortBy (1 thread)", ms, src.size(), check);
+
+    fill(poly);
+    ms = timeMs([&] {
+        sortBy(poly);
+        check = double(*poly[poly.getSize() - 1]);
+    }, 1);
+    report("sortBy (all threads)", ms, src.size(), check);
+
+    fill(poly);
+    ms = timeMs([&] { check = double(*poly[topK(poly, 100).front()]); });
+    report("topK(100)", ms, src.size(), check);
+
+    ms = timeMs([&] { check = percentiles(poly, {50, 90, 99}).front(); });
+    report("percentiles (3)", ms, src.size(), check);
+
+    ms = timeMs([&] { check = double(histogram(poly, 64, 0.0, 200.0).front()); });
+    report("histogram (64 buckets)", ms, src.size(), check);
+}
+
+void benchTransform(const std::vector<Trapezoid<double>>& src) {
+    Array<Trapezoid<double>> poly;
+    poly.reserve(src.size());
+    for (const auto& t : src)
+        poly.add(t);
+    double check = aggregate(poly).totalArea;
+
+    // Поворот туда и обратно, чтобы координаты не уплывали между повторами
+    auto there = AffineTransform::rotate(0.3, Point<double>(500.0, 500.0));
+    auto back = AffineTransform::rotate(-0.3, Point<double>(500.0, 500.0));
+
+    // Вручную: новые фигуры из преобразованных вершин, кеш заполняется заново
+    double ms = timeMs([&] {
+        for (size_t i = 0; i < poly.getSize(); ++i) {
+            auto v = poly[i].getVertices();
+            for (auto& p : v)
+                p = there.apply(p);
+            Trapezoid<double> t(v);
+            check = double(t);
+        }
+    }, 1);
+    report("rebuild rotated figures", ms, src.size(), check);
+
+    ms = timeMs([&] {
+        transformAll(poly, there, 1);
+        transformAll(poly, back, 1);
+        check = double(poly[0]);
+    });
+    report("transformAll x2 (1 thread)", ms, src.size(), check);
+
+    ms = timeMs([&] {
+        transformAll(poly, there);
+        transformAll(poly, back);
+        check = double(poly[0]);
+    });
+    report("transformAll x2 (all threads)", ms, src.size(), check);
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+    std::cout << "Figures: " << count << "\n\n";
+
+    auto trapezoids = makeTrapezoids(count);
+
+    benchTotalArea(trapezoids);
+    benchTextIngest(trapezoids);
+    benchReport(trapezoids);
+    benchNearest(trapezoids);
+    benchContains(trapezoids);
+    benchOverlap(trapezoids);
+    benchRanking(trapezoids);
+    benchTransform(trapezoids);
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Point.h"
+
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// 2x3 affine map (x, y) -> (a x + b y + tx, c x + d y + ty).
+struct AffineTransform {
+    double a = 1.0, b = 0.0, tx = 0.0;
+    double c = 0.0, d = 1.0, ty = 0.0;
+
+    static AffineTransform translate(double dx, double dy) {
+        return {1.0, 0.0, dx, 0.0, 1.0, dy};
+    }
+
+    static AffineTransform scale(double sx, double sy) {
+        return {sx, 0.0, 0.0, 0.0, sy, 0.0};
+    }
+
+    // Counter-clockwise rotation by `radians` around `pivot`.
+    static AffineTransform rotate(double radians, Point<double> pivot = {}) {
+        double cs = std::cos(radians), sn = std::sin(radians);
+        double px = pivot.x(), py = pivot.y();
+        return {cs, -sn, px - cs * px + sn * py,
+                sn, cs, py - sn * px - cs * py};
+    }
+
+    // This map followed by `next`.
+    AffineTransform then(const AffineTransform& next) const {
+        return {next.a * a + next.b * c, next.a * b + next.b * d, next.a * tx + next.b * ty + next.tx,
+                next.c * a + next.d * c, next.c * b + next.d * d, next.c * tx + next.d * ty + next.ty};
+    }
+
+    // Areas scale by |det()|.
+    double det() const {
+        return a * d - b * c;
+    }
+
+    // Integral coordinates are rounded to the nearest integer.
+    template <Scalar T>
+    Point<T> apply(const Point<T>& p) const {
+        double x = static_cast<double>(p.x()), y = static_cast<double>(p.y());
+        double nx = a * x + b * y + tx;
+        double ny = c * x + d * y + ty;
+        if constexpr (std::is_integral_v<T>)
+            return Point<T>(static_cast<T>(std::llround(nx)), static_cast<T>(std::llround(ny)));
+        else
+            return Point<T>(static_cast<T>(nx), static_cast<T>(ny));
+    }
+
+    // Maps pts[0..count) in place; two points per AVX2 step, one per SSE2.
+    void applyInPlace(Point<double>* pts, size_t count) const {
+        static_assert(sizeof(Point<double>) == 2 * sizeof(double));
+        double* xy = reinterpret_cast<double*>(pts);
+        size_t i = 0;
+
+#if defined(__AVX2__)
+        // [x0 y0 x1 y1] * [a d a d] + [y0 x0 y1 x1] * [b c b c] + [tx ty tx ty]
+        const __m256d diag = _mm256_setr_pd(a, d, a, d);
+        const __m256d anti = _mm256_setr_pd(b, c, b, c);
+        const __m256d shift = _mm256_setr_pd(tx, ty, tx, ty);
+        for (; i + 2 <= count; i += 2) {
+            __m256d v = _mm256_loadu_pd(xy + 2 * i);
+            __m256d swapped = _mm256_permute_pd(v, 0x5);
+            __m256d r = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(v, diag), _mm256_mul_pd(swapped, anti)), shift);
+            _mm256_storeu_pd(xy + 2 * i, r);
+        }
+#endif
+#if defined(__SSE2__)
+        const __m128d diag2 = _mm_setr_pd(a, d);
+        const __m128d anti2 = _mm_setr_pd(b, c);
+        const __m128d shift2 = _mm_setr_pd(tx, ty);
+        for (; i < count; ++i) {
+            __m128d v = _mm_loadu_pd(xy + 2 * i);
+            __m128d swapped = _mm_shuffle_pd(v, v, 0x1);
+            _mm_storeu_pd(xy + 2 * i, _mm_add_pd(_mm_add_pd(_mm_mul_pd(v, diag2), _mm_mul_pd(swapped, anti2)), shift2));
+        }
+#endif
+        for (; i < count; ++i)
+            pts[i] = apply(pts[i]);
+    }
+};
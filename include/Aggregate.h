@@ -0,0 +1,139 @@
+#pragma once
+
+#include "Array.h"
+#include "Parallel.h"
+#include "Point.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <vector>
+
+// Neumaier compensated sum: stays accurate when values are repeatedly
+// added and subtracted.
+class CompensatedSum {
+public:
+    void add(double v) noexcept {
+        double t = sum + v;
+        if (std::abs(sum) >= std::abs(v))
+            compensation += (sum - t) + v;
+        else
+            compensation += (v - t) + sum;
+        sum = t;
+    }
+
+    double value() const noexcept {
+        return sum + compensation;
+    }
+
+private:
+    double sum = 0.0;
+    double compensation = 0.0;
+};
+
+// Summary of a collection of figures, produced in one pass.
+struct FigureAggregate {
+    size_t count = 0;
+    double totalArea = 0.0;
+
+    // Area-weighted mean of the figure centers; the plain mean when the
+    // total area is zero.
+    Point<double> centroid;
+
+    // Bounding box over every vertex of every figure.
+    Point<double> min{std::numeric_limits<double>::infinity(),
+                      std::numeric_limits<double>::infinity()};
+    Point<double> max{-std::numeric_limits<double>::infinity(),
+                      -std::numeric_limits<double>::infinity()};
+};
+
+// Mergeable partial sums behind FigureAggregate.
+struct AggregatePartial {
+    size_t count = 0;
+    double area = 0.0;
+    double weightedX = 0.0, weightedY = 0.0;
+    double centerX = 0.0, centerY = 0.0;
+    double minX = std::numeric_limits<double>::infinity();
+    double minY = std::numeric_limits<double>::infinity();
+    double maxX = -std::numeric_limits<double>::infinity();
+    double maxY = -std::numeric_limits<double>::infinity();
+
+    template <typename Fig>
+    void add(const Fig& fig) {
+        double a = static_cast<double>(fig);
+        auto c = fig.center();
+        double cx = static_cast<double>(c.x());
+        double cy = static_cast<double>(c.y());
+
+        ++count;
+        area += a;
+        weightedX += a * cx;
+        weightedY += a * cy;
+        centerX += cx;
+        centerY += cy;
+
+        for (const auto& v : fig.points()) {
+            double x = static_cast<double>(v.x());
+            double y = static_cast<double>(v.y());
+            minX = std::min(minX, x);
+            minY = std::min(minY, y);
+            maxX = std::max(maxX, x);
+            maxY = std::max(maxY, y);
+        }
+    }
+
+    friend AggregatePartial operator+(const AggregatePartial& a, const AggregatePartial& b) {
+        AggregatePartial r;
+        r.count = a.count + b.count;
+        r.area = a.area + b.area;
+        r.weightedX = a.weightedX + b.weightedX;
+        r.weightedY = a.weightedY + b.weightedY;
+        r.centerX = a.centerX + b.centerX;
+        r.centerY = a.centerY + b.centerY;
+        r.minX = std::min(a.minX, b.minX);
+        r.minY = std::min(a.minY, b.minY);
+        r.maxX = std::max(a.maxX, b.maxX);
+        r.maxY = std::max(a.maxY, b.maxY);
+        return r;
+    }
+
+    FigureAggregate result() const {
+        FigureAggregate r;
+        r.count = count;
+        r.totalArea = area;
+        if (area != 0.0)
+            r.centroid = Point<double>(weightedX / area, weightedY / area);
+        else if (count)
+            r.centroid = Point<double>(centerX / count, centerY / count);
+        r.min = Point<double>(minX, minY);
+        r.max = Point<double>(maxX, maxY);
+        return r;
+    }
+};
+
+// Total area, area-weighted centroid and bounding box of `figures` in one
+// pass, split into fixed 4096-element blocks across `threads` threads
+// (0 = all cores). Block partials are merged pairwise in block order, so
+// the result does not depend on the thread count.
+template <typename Elem, size_t Inline, typename Growth>
+FigureAggregate aggregate(const Array<Elem, Inline, Growth>& figures, size_t threads = 0) {
+    constexpr size_t block = 4096;
+    const size_t n = figures.getSize();
+    if (!n)
+        return {};
+
+    size_t blocks = (n + block - 1) / block;
+    std::vector<AggregatePartial> partials(blocks);
+
+    parallelFor(blocks, threads, [&](size_t b) {
+        size_t end = std::min(n, (b + 1) * block);
+
+        AggregatePartial p;
+        for (size_t i = b * block; i < end; ++i)
+            p.add(figureOf(figures.uncheckedAt(i)));
+        partials[b] = p;
+    });
+
+    return pairwiseReduce(partials.data(), blocks, std::plus<>{}).result();
+}
@@ -5,43 +5,175 @@
 #include <stdexcept>
 #include <iomanip>
 #include <type_traits>
+#include <cstring>
+#include <utility>
+#include <algorithm>
 
+// Types that may be moved to a new address with memcpy, leaving nothing to
+// destroy at the old one. Specialize for types known to be safe.
 template <typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
+// The figure behind a container element, whether the element is a figure
+// or a (smart) pointer to one.
+template <typename E>
+const auto& figureOf(const E& elem) {
+    if constexpr (requires { *elem; })
+        return *elem;
+    else
+        return elem;
+}
+
+template <typename E>
+auto& figureOf(E& elem) {
+    if constexpr (requires { *elem; })
+        return *elem;
+    else
+        return elem;
+}
+
+// Growth policies: the capacity an Array grows to when it is full.
+struct GrowDouble {
+    static constexpr size_t next(size_t capacity) noexcept {
+        return capacity ? capacity * 2 : 2;
+    }
+};
+
+struct GrowHalf {   // 1.5x: less slack, more reallocations
+    static constexpr size_t next(size_t capacity) noexcept {
+        return capacity < 2 ? 2 : capacity + capacity / 2;
+    }
+};
+
+struct ArrayMemory {
+    size_t bytesUsed = 0;       // live elements
+    size_t bytesReserved = 0;   // element storage, inline or on the heap
+    size_t heapBytes = 0;       // part of bytesReserved on the heap
+};
+
+// Raw storage for the first N elements inside the Array object itself.
+template <typename T, size_t N>
+struct InlineBuffer {
+    alignas(T) unsigned char bytes[N * sizeof(T)];
+
+    T* get() noexcept { return reinterpret_cast<T*>(bytes); }
+    const T* get() const noexcept { return reinterpret_cast<const T*>(bytes); }
+};
+
+template <typename T>
+struct InlineBuffer<T, 0> {
+    T* get() const noexcept { return nullptr; }
+};
+
+// Growable array. Up to Inline elements are stored inside the object
+// without touching the heap; beyond that storage grows by Growth.
+template <typename T, size_t Inline = 0, typename Growth = GrowDouble>
 class Array {
 public:
-    Array()
-        : data(std::make_shared<T[]>(2)), capacity(2), size(0) {}
+    // Elements are contiguous, so plain pointers serve as iterators and
+    // Array works with range-for, <ranges> and the parallel algorithms.
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
 
-    ~Array() = default;
+    // items is set in the body: local is not initialised yet while the
+    // member initialisers run.
+    Array() noexcept {
+        items = local.get();
+        capacity = Inline;
+    }
+
+    ~Array() {
+        clear();
+        release();
+    }
 
     Array(const Array&) = delete;
     Array& operator=(const Array&) = delete;
 
     Array(Array&& other) noexcept
-        : data(std::move(other.data)),
-          capacity(other.capacity),
-          size(other.size) {
-        other.capacity = 0;
-        other.size = 0;
+        : Array() {
+        take(other);
     }
 
     Array& operator=(Array&& other) noexcept {
         if (this != &other) {
-            data = std::move(other.data);
-            capacity = other.capacity;
-            size = other.size;
+            clear();
+            release();
+            items = local.get();
+            capacity = Inline;
 
-            other.capacity = 0;
-            other.size = 0;
+            take(other);
         }
         return *this;
     }
 
     template <typename U>
     void add(U&& elem) {
-        if (size >= capacity)
-            grow();
-        data[size++] = std::forward<U>(elem);
+        emplace(std::forward<U>(elem));
+    }
+
+    template <typename... Args>
+    T& emplace(Args&&... args) {
+        if (size < capacity) {
+            std::construct_at(items + size, std::forward<Args>(args)...);
+            return items[size++];
+        }
+
+        // Construct into the new buffer first: args may refer to an element
+        // of the old one.
+        size_t newCapacity = std::max(Growth::next(capacity), capacity + 1);
+        T* newData = allocate(newCapacity);
+        try {
+            std::construct_at(newData + size, std::forward<Args>(args)...);
+        } catch (...) {
+            deallocate(newData, newCapacity);
+            throw;
+        }
+
+        relocate(newData, newCapacity);
+        return items[size++];
+    }
+
+    void reserve(size_t newCapacity) {
+        if (newCapacity <= capacity)
+            return;
+
+        relocate(allocate(newCapacity), newCapacity);
+    }
+
+    void clear() noexcept {
+        std::destroy_n(items, size);
+        size = 0;
+    }
+
+    // Releases unused capacity: back to the inline buffer when the
+    // elements fit, otherwise to a heap block of exactly getSize().
+    void shrinkToFit() {
+        if (isInline() || size == capacity)
+            return;
+
+        if (!size && !Inline) {
+            release();
+            items = nullptr;
+            capacity = 0;
+        } else if (size <= Inline) {
+            relocate(local.get(), Inline);
+        } else {
+            relocate(allocate(size), size);
+        }
+    }
+
+    ArrayMemory memoryUsage() const noexcept {
+        ArrayMemory m;
+        m.bytesUsed = size * sizeof(T);
+        m.bytesReserved = capacity * sizeof(T);
+        m.heapBytes = isInline() ? 0 : m.bytesReserved;
+        return m;
+    }
+
+    bool isInline() const noexcept {
+        return Inline && items == local.get();
     }
 
     void remove(size_t index) {
@@ -51,12 +183,49 @@ public:
             throw std::out_of_range("Index out of range");
 
         for (size_t i = index; i + 1 < size; ++i)
-            data[i] = std::move(data[i + 1]);
+            items[i] = std::move(items[i + 1]);
 
-        if constexpr (requires { data[size - 1].reset(); })
-            data[size - 1].reset();
+        std::destroy_at(items + --size);
+    }
+
+    // O(1) removal that fills the hole with the last element; order is not kept.
+    void swapRemove(size_t index) {
+        if (!size)
+            throw std::out_of_range("Array is empty");
+        if (index >= size)
+            throw std::out_of_range("Index out of range");
+
+        if (index + 1 != size)
+            items[index] = std::move(items[size - 1]);
+
+        std::destroy_at(items + --size);
+    }
+
+    // Removes elements [first, last) in a single shift of the tail.
+    void removeRange(size_t first, size_t last) {
+        if (first > last || last > size)
+            throw std::out_of_range("Index out of range");
+
+        std::move(items + last, items + size, items + first);
+        truncate(size - (last - first));
+    }
+
+    // Removes every element matching pred in one O(n) pass, keeping order.
+    // Returns the number of removed elements.
+    template <typename Pred>
+    size_t eraseIf(Pred pred) {
+        size_t kept = 0;
+        for (size_t i = 0; i < size; ++i) {
+            if (pred(std::as_const(items[i])))
+                continue;
+            if (kept != i)
+                items[kept] = std::move(items[i]);
+            ++kept;
+        }
 
-        --size;
+        size_t removed = size - kept;
+        truncate(kept);
+        return removed;
     }
 
     void printAll() const {
@@ -66,12 +235,12 @@ public:
         std::cout << std::fixed << std::setprecision(4);
 
         for (size_t i = 0; i < size; ++i) {
-            if constexpr (requires { *data[i]; }) {
-                std::cout << i << ": " << *data[i]
-                          << " | Area = " << static_cast<double>(*data[i]) << "\n";
+            if constexpr (requires { *items[i]; }) {
+                std::cout << i << ": " << *items[i]
+                          << " | Area = " << static_cast<double>(*items[i]) << "\n";
             } else {
-                std::cout << i << ": " << data[i]
-                          << " | Area = " << static_cast<double>(data[i]) << "\n";
+                std::cout << i << ": " << items[i]
+                          << " | Area = " << static_cast<double>(items[i]) << "\n";
             }
         }
     }
@@ -81,11 +250,11 @@ public:
             throw std::out_of_range("Array is empty");
 
         for (size_t i = 0; i < size; ++i) {
-            if constexpr (requires { data[i]->center(); }) {
-                auto c = data[i]->center();
+            if constexpr (requires { items[i]->center(); }) {
+                auto c = items[i]->center();
                 std::cout << i << ": Center = (" << c.x() << ", " << c.y() << ")\n";
-            } else if constexpr (requires { data[i].center(); }) {
-                auto c = data[i].center();
+            } else if constexpr (requires { items[i].center(); }) {
+                auto c = items[i].center();
                 std::cout << i << ": Center = (" << c.x() << ", " << c.y() << ")\n";
             }
         }
@@ -97,10 +266,10 @@ public:
 
         double totalArea = 0.0;
         for (size_t i = 0; i < size; ++i) {
-            if constexpr (requires { double(data[i]); })
-                totalArea += static_cast<double>(data[i]);
-            else if constexpr (requires { double(*data[i]); })
-                totalArea += static_cast<double>(*data[i]);
+            if constexpr (requires { double(items[i]); })
+                totalArea += static_cast<double>(items[i]);
+            else if constexpr (requires { double(*items[i]); })
+                totalArea += static_cast<double>(*items[i]);
         }
 
         std::cout << "Total Area: " << totalArea << "\n";
@@ -109,32 +278,109 @@ public:
     T& operator[](size_t index) {
         if (index >= size)
             throw std::out_of_range("Index out of range");
-        return data[index];
+        return items[index];
     }
 
     const T& operator[](size_t index) const {
         if (index >= size)
             throw std::out_of_range("Index out of range");
-        return data[index];
+        return items[index];
+    }
+
+    // Unchecked access for hot loops; index must be < getSize().
+    T& uncheckedAt(size_t index) noexcept {
+        return items[index];
+    }
+
+    const T& uncheckedAt(size_t index) const noexcept {
+        return items[index];
     }
 
+    T* data() noexcept { return items; }
+    const T* data() const noexcept { return items; }
+
+    iterator begin() noexcept { return items; }
+    iterator end() noexcept { return items + size; }
+    const_iterator begin() const noexcept { return items; }
+    const_iterator end() const noexcept { return items + size; }
+    const_iterator cbegin() const noexcept { return items; }
+    const_iterator cend() const noexcept { return items + size; }
+
     size_t getSize() const {
         return size;
     }
 
+    size_t getCapacity() const {
+        return capacity;
+    }
+
 private:
-    void grow() {
-        capacity = (capacity == 0) ? 2 : capacity * 2;
-        auto newData = std::make_shared<T[]>(capacity);
+    template <typename U, size_t I, typename G>
+    friend class Array;
+
+    void truncate(size_t newSize) noexcept {
+        std::destroy(items + newSize, items + size);
+        size = newSize;
+    }
 
-        for (size_t i = 0; i < size; ++i)
-            newData[i] = std::move(data[i]);
+    // Moves other's elements into this (empty, inline) Array and leaves
+    // other empty and inline.
+    void take(Array& other) noexcept {
+        if (other.isInline()) {
+            moveElements(other.items, items, other.size);
+            size = std::exchange(other.size, 0);
+        } else {
+            items = std::exchange(other.items, other.local.get());
+            capacity = std::exchange(other.capacity, Inline);
+            size = std::exchange(other.size, 0);
+        }
+    }
+
+    // Frees the heap buffer, if any.
+    void release() noexcept {
+        if (!isInline())
+            deallocate(items, capacity);
+    }
 
-        data = std::move(newData);
+    static T* allocate(size_t count) {
+        return std::allocator<T>().allocate(count);
+    }
+
+    static void deallocate(T* ptr, size_t count) noexcept {
+        if (ptr)
+            std::allocator<T>().deallocate(ptr, count);
+    }
+
+    // Moves the live elements into newData (raw storage for newCapacity
+    // elements) and releases the old buffer.
+    void relocate(T* newData, size_t newCapacity) noexcept {
+        static_assert(IsTriviallyRelocatable<T>::value ||
+                      std::is_nothrow_move_constructible_v<T>,
+                      "Array<T> requires a noexcept move constructor");
+
+        moveElements(items, newData, size);
+        release();
+        items = newData;
+        capacity = newCapacity;
+    }
+
+    // Moves count elements from src to raw storage at dst, ending their
+    // lifetime at src.
+    static void moveElements(T* src, T* dst, size_t count) noexcept {
+        if constexpr (IsTriviallyRelocatable<T>::value) {
+            if (count)
+                std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), count * sizeof(T));
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                std::construct_at(dst + i, std::move(src[i]));
+                std::destroy_at(src + i);
+            }
+        }
     }
 
 private:
-    std::shared_ptr<T[]> data;
-    size_t capacity;
-    size_t size;
+    T* items = nullptr;
+    size_t capacity = 0;
+    size_t size = 0;
+    [[no_unique_address]] InlineBuffer<T, Inline> local;
 };
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Append-only array for many writer threads and many reader threads.
+//
+// Elements live in segments of doubling size that are never moved or freed
+// while the array exists, so an index stays valid forever. add() claims a
+// slot with one fetch_add, constructs the element in place and marks it
+// ready; the published size advances over the ready prefix. snapshot()
+// reads that size once and sees a consistent prefix, without blocking
+// writers.
+template <typename T>
+class ConcurrentArray {
+    static constexpr size_t firstSegment = 64;
+    static constexpr size_t maxSegments = 48;
+
+    struct Slot {
+        alignas(T) unsigned char bytes[sizeof(T)];
+        std::atomic<bool> ready{false};
+
+        T& value() { return *std::launder(reinterpret_cast<T*>(bytes)); }
+        const T& value() const { return *std::launder(reinterpret_cast<const T*>(bytes)); }
+    };
+
+public:
+    class Snapshot {
+    public:
+        size_t getSize() const {
+            return size;
+        }
+
+        const T& operator[](size_t index) const {
+            if (index >= size)
+                throw std::out_of_range("Index out of range");
+            return owner->slot(index).value();
+        }
+
+    private:
+        friend class ConcurrentArray;
+
+        Snapshot(const ConcurrentArray* owner, size_t size)
+            : owner(owner), size(size) {}
+
+        const ConcurrentArray* owner;
+        size_t size;
+    };
+
+    ConcurrentArray() = default;
+
+    ~ConcurrentArray() {
+        size_t n = claimed.load(std::memory_order_acquire);
+        for (size_t i = 0; i < n; ++i)
+            std::destroy_at(&slot(i).value());
+
+        for (auto& seg : segments)
+            delete[] seg.load(std::memory_order_relaxed);
+    }
+
+    ConcurrentArray(const ConcurrentArray&) = delete;
+    ConcurrentArray& operator=(const ConcurrentArray&) = delete;
+
+    template <typename U>
+    size_t add(U&& elem) {
+        return emplace(std::forward<U>(elem));
+    }
+
+    // Constructs an element and returns its (stable) index. The element is
+    // built before a slot is claimed and then moved in, because a claimed
+    // slot that never becomes ready would stall the published size.
+    template <typename... Args>
+    size_t emplace(Args&&... args) {
+        static_assert(std::is_nothrow_move_constructible_v<T>,
+                      "ConcurrentArray elements must be nothrow move constructible");
+
+        T value(std::forward<Args>(args)...);
+
+        size_t index = claimed.fetch_add(1, std::memory_order_relaxed);
+        Slot& s = slotForWrite(index);
+
+        std::construct_at(reinterpret_cast<T*>(s.bytes), std::move(value));
+        // seq_cst (here and in advancePublished) so that of two writers
+        // finishing neighbouring slots at once, at least one sees both ready.
+        s.ready.store(true);
+
+        advancePublished();
+        return index;
+    }
+
+    // Number of elements visible to readers.
+    size_t getSize() const {
+        return published.load(std::memory_order_acquire);
+    }
+
+    Snapshot snapshot() const {
+        return Snapshot(this, published.load(std::memory_order_acquire));
+    }
+
+    const T& operator[](size_t index) const {
+        if (index >= getSize())
+            throw std::out_of_range("Index out of range");
+        return slot(index).value();
+    }
+
+private:
+    // Segment k holds firstSegment << k slots and starts at
+    // firstSegment * (2^k - 1).
+    static size_t segmentOf(size_t index) {
+        return std::bit_width(index / firstSegment + 1) - 1;
+    }
+
+    static size_t segmentStart(size_t seg) {
+        return firstSegment * ((size_t{1} << seg) - 1);
+    }
+
+    Slot& slot(size_t index) const {
+        size_t seg = segmentOf(index);
+        return segments[seg].load(std::memory_order_acquire)[index - segmentStart(seg)];
+    }
+
+    // Terminates if the segment cannot be allocated; see emplace().
+    Slot& slotForWrite(size_t index) noexcept {
+        size_t seg = segmentOf(index);
+        if (seg >= maxSegments)
+            std::terminate();
+
+        Slot* data = segments[seg].load(std::memory_order_acquire);
+        if (!data) {
+            Slot* fresh = new (std::nothrow) Slot[firstSegment << seg];
+            if (!fresh)
+                std::terminate();
+            if (segments[seg].compare_exchange_strong(data, fresh, std::memory_order_acq_rel))
+                data = fresh;
+            else
+                delete[] fresh;
+        }
+        return data[index - segmentStart(seg)];
+    }
+
+    bool isReady(size_t index) const {
+        size_t seg = segmentOf(index);
+        Slot* data = segments[seg].load(std::memory_order_acquire);
+        return data && data[index - segmentStart(seg)].ready.load();
+    }
+
+    // Moves the published size over every consecutive ready slot.
+    void advancePublished() {
+        size_t n = published.load();
+        while (n < claimed.load() && isReady(n)) {
+            if (published.compare_exchange_weak(n, n + 1))
+                ++n;
+        }
+    }
+
+private:
+    mutable std::array<std::atomic<Slot*>, maxSegments> segments{};
+    std::atomic<size_t> claimed{0};
+    std::atomic<size_t> published{0};
+};
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "Array.h"
+#include "Parallel.h"
+#include "SpatialGrid.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Batch point-in-polygon tests. Results follow polygonContains(): a point
+// on the boundary is inside.
+
+inline constexpr size_t noFigure = static_cast<size_t>(-1);
+
+namespace containment_detail {
+
+inline constexpr size_t pointBlock = 4096;
+
+// One polygon edge a -> b, prepared for testing many points against it.
+struct Edge {
+    double ax, ay, by, dx, dy;
+    double minX, maxX, minY, maxY;
+    bool up;        // b.y > a.y
+};
+
+inline std::vector<Edge> edgesOf(std::span<const Point<double>> poly) {
+    std::vector<Edge> edges;
+    edges.reserve(poly.size());
+    for (size_t i = 0, j = poly.size() - 1; i < poly.size(); j = i++) {
+        const Point<double>& a = poly[j];
+        const Point<double>& b = poly[i];
+        edges.push_back({a.x(), a.y(), b.y(), b.x() - a.x(), b.y() - a.y(),
+                         std::min(a.x(), b.x()), std::max(a.x(), b.x()),
+                         std::min(a.y(), b.y()), std::max(a.y(), b.y()),
+                         b.y() > a.y()});
+    }
+    return edges;
+}
+
+// Flags for pts[0..count): the crossing-number test run over all edges for
+// several points at once, with the "on an edge" check folded in as a mask.
+inline size_t containsKernel(const std::vector<Edge>& edges, const Point<double>* pts,
+                             size_t count, std::uint8_t* out) {
+    static_assert(sizeof(Point<double>) == 2 * sizeof(double));
+    const double* xy = reinterpret_cast<const double*>(pts);
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    for (; i + 4 <= count; i += 4) {
+        // [x0 y0 x1 y1] [x2 y2 x3 y3] -> [x0 x1 x2 x3] [y0 y1 y2 y3]
+        __m256d lo = _mm256_loadu_pd(xy + 2 * i);
+        __m256d hi = _mm256_loadu_pd(xy + 2 * i + 4);
+        __m256d px = _mm256_permute4x64_pd(_mm256_unpacklo_pd(lo, hi), 0xD8);
+        __m256d py = _mm256_permute4x64_pd(_mm256_unpackhi_pd(lo, hi), 0xD8);
+
+        __m256d inside = _mm256_setzero_pd();
+        __m256d onEdge = _mm256_setzero_pd();
+        const __m256d zero = _mm256_setzero_pd();
+
+        for (const Edge& e : edges) {
+            __m256d ax = _mm256_set1_pd(e.ax), ay = _mm256_set1_pd(e.ay);
+            __m256d cross = _mm256_sub_pd(_mm256_mul_pd(_mm256_set1_pd(e.dx), _mm256_sub_pd(py, ay)),
+                                          _mm256_mul_pd(_mm256_set1_pd(e.dy), _mm256_sub_pd(px, ax)));
+
+            __m256d straddle = _mm256_xor_pd(_mm256_cmp_pd(ay, py, _CMP_GT_OQ),
+                                             _mm256_cmp_pd(_mm256_set1_pd(e.by), py, _CMP_GT_OQ));
+            __m256d side = e.up ? _mm256_cmp_pd(cross, zero, _CMP_GT_OQ)
+                                : _mm256_cmp_pd(cross, zero, _CMP_LT_OQ);
+            inside = _mm256_xor_pd(inside, _mm256_and_pd(straddle, side));
+
+            __m256d on = _mm256_and_pd(_mm256_cmp_pd(cross, zero, _CMP_EQ_OQ),
+                         _mm256_and_pd(_mm256_and_pd(_mm256_cmp_pd(px, _mm256_set1_pd(e.minX), _CMP_GE_OQ),
+                                                     _mm256_cmp_pd(px, _mm256_set1_pd(e.maxX), _CMP_LE_OQ)),
+                                       _mm256_and_pd(_mm256_cmp_pd(py, _mm256_set1_pd(e.minY), _CMP_GE_OQ),
+                                                     _mm256_cmp_pd(py, _mm256_set1_pd(e.maxY), _CMP_LE_OQ))));
+            onEdge = _mm256_or_pd(onEdge, on);
+        }
+
+        int mask = _mm256_movemask_pd(_mm256_or_pd(inside, onEdge));
+        for (int l = 0; l < 4; ++l)
+            out[i + l] = (mask >> l) & 1;
+    }
+#elif defined(__SSE2__)
+    for (; i + 2 <= count; i += 2) {
+        __m128d p0 = _mm_loadu_pd(xy + 2 * i);
+        __m128d p1 = _mm_loadu_pd(xy + 2 * i + 2);
+        __m128d px = _mm_unpacklo_pd(p0, p1);
+        __m128d py = _mm_unpackhi_pd(p0, p1);
+
+        __m128d inside = _mm_setzero_pd();
+        __m128d onEdge = _mm_setzero_pd();
+        const __m128d zero = _mm_setzero_pd();
+
+        for (const Edge& e : edges) {
+            __m128d ax = _mm_set1_pd(e.ax), ay = _mm_set1_pd(e.ay);
+            __m128d cross = _mm_sub_pd(_mm_mul_pd(_mm_set1_pd(e.dx), _mm_sub_pd(py, ay)),
+                                       _mm_mul_pd(_mm_set1_pd(e.dy), _mm_sub_pd(px, ax)));
+
+            __m128d straddle = _mm_xor_pd(_mm_cmpgt_pd(ay, py), _mm_cmpgt_pd(_mm_set1_pd(e.by), py));
+            __m128d side = e.up ? _mm_cmpgt_pd(cross, zero) : _mm_cmplt_pd(cross, zero);
+            inside = _mm_xor_pd(inside, _mm_and_pd(straddle, side));
+
+            __m128d on = _mm_and_pd(_mm_cmpeq_pd(cross, zero),
+                         _mm_and_pd(_mm_and_pd(_mm_cmpge_pd(px, _mm_set1_pd(e.minX)),
+                                               _mm_cmple_pd(px, _mm_set1_pd(e.maxX))),
+                                    _mm_and_pd(_mm_cmpge_pd(py, _mm_set1_pd(e.minY)),
+                                               _mm_cmple_pd(py, _mm_set1_pd(e.maxY)))));
+            onEdge = _mm_or_pd(onEdge, on);
+        }
+
+        int mask = _mm_movemask_pd(_mm_or_pd(inside, onEdge));
+        out[i] = mask & 1;
+        out[i + 1] = (mask >> 1) & 1;
+    }
+#endif
+
+    return i;
+}
+
+}
+
+// Flags for a batch of points against one figure (1 = contained). Points
+// are processed in fixed blocks across `threads` threads (0 = hardware
+// concurrency); double coordinates use the SIMD kernel.
+template <Scalar T, typename Fig>
+std::vector<std::uint8_t> containsBatch(const Fig& fig, std::span<const Point<T>> pts, size_t threads = 0) {
+    using namespace containment_detail;
+
+    std::vector<std::uint8_t> out(pts.size());
+    std::span<const Point<T>> poly = fig.points();
+
+    std::vector<Edge> edges;
+    if constexpr (std::is_same_v<T, double>)
+        edges = edgesOf(poly);
+
+    size_t blocks = (pts.size() + pointBlock - 1) / pointBlock;
+    parallelFor(blocks, threads, [&](size_t b) {
+        size_t first = b * pointBlock;
+        size_t count = std::min(pts.size() - first, pointBlock);
+
+        size_t done = 0;
+        if constexpr (std::is_same_v<T, double>)
+            done = containsKernel(edges, pts.data() + first, count, out.data() + first);
+
+        for (size_t i = done; i < count; ++i)
+            out[first + i] = polygonContains(poly, pts[first + i]);
+    });
+    return out;
+}
+
+// For each point, the lowest index of a figure in `figures` containing it,
+// or noFigure. Candidates come from a SpatialGrid built over the figures.
+template <Scalar T, typename Elem, size_t Inline, typename Growth>
+std::vector<size_t> classifyPoints(const Array<Elem, Inline, Growth>& figures, std::span<const Point<T>> pts,
+                                   size_t threads = 0) {
+    using containment_detail::pointBlock;
+
+    std::vector<size_t> out(pts.size(), noFigure);
+    if (!figures.getSize())
+        return out;
+
+    auto grid = SpatialGrid<T>::build(figures);
+
+    size_t blocks = (pts.size() + pointBlock - 1) / pointBlock;
+    parallelFor(blocks, threads, [&](size_t b) {
+        std::vector<size_t> hits;
+        size_t last = std::min(pts.size(), (b + 1) * pointBlock);
+        for (size_t i = b * pointBlock; i < last; ++i) {
+            hits.clear();
+            grid.containing(figures, pts[i], hits);
+            if (!hits.empty())
+                out[i] = *std::min_element(hits.begin(), hits.end());
+        }
+    });
+    return out;
+}
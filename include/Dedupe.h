@@ -0,0 +1,149 @@
+#pragma once
+
+#include "Array.h"
+#include "Hash.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Hash-based equality passes over an Array. Figures are grouped by hash()
+// and compared with operator== only within a group, so every pass is O(n)
+// expected instead of O(n^2).
+
+namespace dedupe_detail {
+
+inline constexpr size_t block = 4096;
+
+// Hash partitions for a pass over `count` elements: one for small arrays,
+// otherwise enough to spread over threads.
+inline size_t partitionsFor(size_t count) {
+    return count < 65536 ? 1 : 64;
+}
+
+template <typename Elem, size_t Inline, typename Growth>
+std::vector<std::uint64_t> hashes(const Array<Elem, Inline, Growth>& figures, size_t threads) {
+    const size_t n = figures.getSize();
+    std::vector<std::uint64_t> out(n);
+    parallelFor((n + block - 1) / block, threads, [&](size_t b) {
+        size_t end = std::min(n, (b + 1) * block);
+        for (size_t i = b * block; i < end; ++i)
+            out[i] = figureOf(figures.uncheckedAt(i)).hash();
+    });
+    return out;
+}
+
+// For each element, the index of the first element equal to it (itself
+// if it is the first). Partitions are independent; within one, indices
+// are visited in ascending order.
+template <typename Elem, size_t Inline, typename Growth>
+std::vector<size_t> firstOccurrences(const Array<Elem, Inline, Growth>& figures, const HashPartitions& parts,
+                                     size_t threads) {
+    std::vector<size_t> first(figures.getSize());
+
+    parallelFor(parts.partitions(), threads, [&](size_t k) {
+        HashTable table(parts.start[k + 1] - parts.start[k]);
+        for (size_t p = parts.start[k]; p < parts.start[k + 1]; ++p) {
+            size_t i = parts.ids[p];
+            size_t f = table.find(parts.hashes[i], parts.hashes, [&](size_t c) {
+                return figureOf(figures.uncheckedAt(c)) == figureOf(figures.uncheckedAt(i));
+            });
+            if (f != HashTable::npos) {
+                first[i] = f;
+            } else {
+                first[i] = i;
+                table.insert(i, parts.hashes[i]);
+            }
+        }
+    });
+    return first;
+}
+
+template <typename Elem, size_t Inline, typename Growth>
+std::vector<size_t> firstOccurrences(const Array<Elem, Inline, Growth>& figures, size_t threads) {
+    auto parts = HashPartitions::build(hashes(figures, threads), partitionsFor(figures.getSize()));
+    return firstOccurrences(figures, parts, threads);
+}
+
+}
+
+// Removes every element equal to an earlier one, keeping the first
+// occurrences in order. Returns the number of removed elements.
+template <typename Elem, size_t Inline, typename Growth>
+size_t dedupe(Array<Elem, Inline, Growth>& figures, size_t threads = 0) {
+    std::vector<size_t> first = dedupe_detail::firstOccurrences(figures, threads);
+    const size_t n = figures.getSize();
+
+    size_t kept = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (first[i] != i)
+            continue;
+        if (kept != i)
+            figures.uncheckedAt(kept) = std::move(figures.uncheckedAt(i));
+        ++kept;
+    }
+
+    figures.removeRange(kept, n);
+    return n - kept;
+}
+
+// Number of distinct elements.
+template <typename Elem, size_t Inline, typename Growth>
+size_t uniqueCount(const Array<Elem, Inline, Growth>& figures, size_t threads = 0) {
+    std::vector<size_t> first = dedupe_detail::firstOccurrences(figures, threads);
+
+    size_t count = 0;
+    for (size_t i = 0; i < first.size(); ++i)
+        count += first[i] == i;
+    return count;
+}
+
+// Every pair (i, j) with left[i] equal to right[j], sorted.
+template <typename L, size_t LI, typename LG, typename R, size_t RI, typename RG>
+std::vector<std::pair<size_t, size_t>> hashJoin(const Array<L, LI, LG>& left, const Array<R, RI, RG>& right,
+                                                size_t threads = 0) {
+    using namespace dedupe_detail;
+    const size_t n = left.getSize();
+
+    HashPartitions lp = HashPartitions::build(hashes(left, threads), partitionsFor(n));
+    HashPartitions rp = HashPartitions::build(hashes(right, threads), lp.partitions());
+
+    // Duplicates on the left are chained behind their first occurrence.
+    std::vector<size_t> first = firstOccurrences(left, lp, threads);
+    std::vector<size_t> nextEqual(n, n);
+    std::vector<size_t> lastEqual(n);
+    for (size_t i = 0; i < n; ++i) {
+        lastEqual[i] = i;
+        if (first[i] != i) {
+            nextEqual[lastEqual[first[i]]] = i;
+            lastEqual[first[i]] = i;
+        }
+    }
+
+    std::vector<std::vector<std::pair<size_t, size_t>>> found(lp.partitions());
+    parallelFor(lp.partitions(), threads, [&](size_t k) {
+        HashTable table(lp.start[k + 1] - lp.start[k]);
+        for (size_t p = lp.start[k]; p < lp.start[k + 1]; ++p) {
+            size_t i = lp.ids[p];
+            if (first[i] == i)
+                table.insert(i, lp.hashes[i]);
+        }
+
+        for (size_t p = rp.start[k]; p < rp.start[k + 1]; ++p) {
+            size_t j = rp.ids[p];
+            size_t i = table.find(rp.hashes[j], lp.hashes, [&](size_t c) {
+                return figureOf(left.uncheckedAt(c)) == figureOf(right.uncheckedAt(j));
+            });
+            for (; i < n; i = nextEqual[i])
+                found[k].emplace_back(i, j);
+        }
+    });
+
+    std::vector<std::pair<size_t, size_t>> pairs;
+    for (const auto& f : found)
+        pairs.insert(pairs.end(), f.begin(), f.end());
+    std::sort(pairs.begin(), pairs.end());
+    return pairs;
+}
@@ -1,7 +1,28 @@
 #pragma once
 
+#include "Affine.h"
 #include "Point.h"
 
+#include <atomic>
+#include <cstdint>
+#include <span>
+
+template <Scalar T>
+struct BoundingBox {
+    Point<T> min;
+    Point<T> max;
+
+    bool operator==(const BoundingBox&) const = default;
+};
+
+// Derived quantities a figure computes once and keeps until it changes.
+template <Scalar T>
+struct FigureCache {
+    double area = 0.0;
+    Point<T> center;
+    BoundingBox<T> box;
+};
+
 template <Scalar T>
 class Figure {
 public:
@@ -9,12 +30,28 @@ public:
 
     virtual Point<T> center() const = 0;
     virtual operator double() const = 0;
+    virtual BoundingBox<T> boundingBox() const = 0;
+    virtual bool contains(const Point<T>& p) const = 0;   // boundary counts as inside
+    virtual void transform(const AffineTransform& m) = 0;  // in place
     virtual bool equals(const Figure<T>& other) const = 0;
+    virtual std::span<const Point<T>> points() const = 0;
+    virtual const char* typeName() const = 0;
+    virtual std::uint64_t hash() const = 0;   // stable; equal figures hash equally
 
     bool operator==(const Figure<T>& other) const {
         return equals(other);
     }
 
+    bool isCached() const noexcept {
+        return cacheState.load(std::memory_order_acquire) == Ready;
+    }
+
+    // Bytes each figure spends on the cache (everything Figure stores
+    // besides its vtable pointer).
+    static constexpr size_t cacheOverhead() noexcept {
+        return sizeof(Figure) - sizeof(void*);
+    }
+
     friend std::ostream& operator<<(std::ostream& os, const Figure<T>& fig) {
         fig.print(os);
         return os;
@@ -22,12 +59,69 @@ public:
 
     friend std::istream& operator>>(std::istream& is, Figure<T>& fig) {
         fig.read(is);
+        fig.invalidate();
         return is;
     }
 
 protected:
     Figure() = default;
 
+    Figure(const Figure& other) noexcept {
+        copyCache(other);
+    }
+
+    Figure& operator=(const Figure& other) noexcept {
+        if (this != &other)
+            copyCache(other);
+        return *this;
+    }
+
     virtual void print(std::ostream& os) const = 0;
     virtual void read(std::istream& is) = 0;
+    virtual FigureCache<T> computeCache() const = 0;
+
+    // Cached area, center and bounding box; computed on first use.
+    // Safe to call from several threads at once: only one of them fills
+    // the cache, the others use their own result.
+    FigureCache<T> metrics() const {
+        if (cacheState.load(std::memory_order_acquire) == Ready)
+            return cache;
+
+        FigureCache<T> fresh = computeCache();
+
+        uint8_t expected = Empty;
+        if (cacheState.compare_exchange_strong(expected, Busy, std::memory_order_acquire)) {
+            cache = fresh;
+            cacheState.store(Ready, std::memory_order_release);
+        }
+        return fresh;
+    }
+
+    // Must be called by every mutator after the vertices change.
+    void invalidate() noexcept {
+        cacheState.store(Empty, std::memory_order_release);
+    }
+
+    // Alternative to invalidate() for mutators that know how the cached
+    // values change: applies fn to the cache if it is filled.
+    template <typename Fn>
+    void updateCache(Fn&& fn) {
+        if (cacheState.load(std::memory_order_acquire) == Ready)
+            fn(cache);
+    }
+
+private:
+    enum : uint8_t { Empty, Busy, Ready };
+
+    void copyCache(const Figure& other) noexcept {
+        if (other.cacheState.load(std::memory_order_acquire) == Ready) {
+            cache = other.cache;
+            cacheState.store(Ready, std::memory_order_release);
+        } else {
+            cacheState.store(Empty, std::memory_order_release);
+        }
+    }
+
+    mutable std::atomic<uint8_t> cacheState{Empty};
+    mutable FigureCache<T> cache;
 };
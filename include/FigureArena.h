@@ -0,0 +1,151 @@
+#pragma once
+
+#include "Trapezoid.h"
+#include "Rhombus.h"
+#include "Pentagon.h"
+
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <typeindex>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+// Types whose destructor has no observable effect, so the arena may free
+// their storage without running it. Specialize for such types.
+template <typename T>
+struct IsTriviallyDisposable : std::is_trivially_destructible<T> {};
+
+template <Scalar T> struct IsTriviallyDisposable<Trapezoid<T>> : std::true_type {};
+template <Scalar T> struct IsTriviallyDisposable<Rhombus<T>>   : std::true_type {};
+template <Scalar T> struct IsTriviallyDisposable<Pentagon<T>>  : std::true_type {};
+
+struct ArenaStats {
+    size_t objects = 0;         // figures created
+    size_t allocations = 0;     // slabs requested from the heap
+    size_t bytesUsed = 0;       // bytes occupied by figures
+    size_t bytesReserved = 0;   // bytes held in slabs
+};
+
+// Slab allocator for polymorphic figures. Figures of the same concrete type
+// are packed contiguously into slabs that grow geometrically; everything is
+// released together when the arena (and every handle from share()) is gone.
+// Slabs are set up on the first create(), so a new, released or moved-from
+// arena holds no memory and is ready for use. Not thread-safe.
+class FigureArena {
+public:
+    explicit FigureArena(size_t firstSlab = 64)
+        : firstSlab(firstSlab ? firstSlab : 1) {}
+
+    FigureArena(const FigureArena&) = delete;
+    FigureArena& operator=(const FigureArena&) = delete;
+
+    FigureArena(FigureArena&&) noexcept = default;
+    FigureArena& operator=(FigureArena&&) noexcept = default;
+
+    // Constructs a figure in the arena. The pointer stays valid until the
+    // arena is destroyed or released.
+    template <typename Fig, typename... Args>
+    Fig* create(Args&&... args) {
+        if (!storage)
+            storage = std::make_shared<Storage>(firstSlab);
+
+        void* slot = storage->allocate(typeid(Fig), sizeof(Fig), alignof(Fig));
+        Fig* fig = ::new (slot) Fig(std::forward<Args>(args)...);
+
+        if constexpr (!IsTriviallyDisposable<Fig>::value)
+            storage->destructors.push_back({fig, [](void* p) { static_cast<Fig*>(p)->~Fig(); }});
+        return fig;
+    }
+
+    // Like create(), but returns a shared_ptr that shares the arena's single
+    // control block (no per-figure heap block), so it can be stored in
+    // Array<std::shared_ptr<Figure<T>>> and keeps the slabs alive.
+    template <typename Fig, typename... Args>
+    std::shared_ptr<Fig> share(Args&&... args) {
+        Fig* fig = create<Fig>(std::forward<Args>(args)...);
+        return std::shared_ptr<Fig>(storage, fig);
+    }
+
+    // Drops the arena's hold on all figures created so far. With no
+    // outstanding share() handles the slabs are freed immediately.
+    void release() {
+        storage.reset();
+    }
+
+    ArenaStats stats() const {
+        return storage ? storage->stats : ArenaStats{};
+    }
+
+private:
+    struct Slab {
+        void* memory;
+        size_t bytes;
+        size_t align;
+    };
+
+    struct Pool {
+        std::type_index type;
+        size_t objectSize;
+        size_t align;
+        size_t capacity = 0;    // objects in the current slab
+        size_t used = 0;
+        char* current = nullptr;
+    };
+
+    struct Storage {
+        explicit Storage(size_t firstSlab) : firstSlab(firstSlab) {}
+
+        ~Storage() {
+            for (auto it = destructors.rbegin(); it != destructors.rend(); ++it)
+                it->second(it->first);
+            for (const Slab& s : slabs)
+                ::operator delete(s.memory, s.bytes, std::align_val_t(s.align));
+        }
+
+        void* allocate(std::type_index type, size_t size, size_t align) {
+            Pool& pool = poolFor(type, size, align);
+
+            if (pool.used == pool.capacity) {
+                size_t count = pool.capacity ? std::min(pool.capacity * 2, maxSlab) : firstSlab;
+                size_t bytes = count * pool.objectSize;
+
+                void* memory = ::operator new(bytes, std::align_val_t(align));
+                slabs.push_back({memory, bytes, align});
+
+                pool.current = static_cast<char*>(memory);
+                pool.capacity = count;
+                pool.used = 0;
+
+                ++stats.allocations;
+                stats.bytesReserved += bytes;
+            }
+
+            ++stats.objects;
+            stats.bytesUsed += pool.objectSize;
+            return pool.current + pool.objectSize * pool.used++;
+        }
+
+        Pool& poolFor(std::type_index type, size_t size, size_t align) {
+            for (Pool& p : pools)
+                if (p.type == type)
+                    return p;
+
+            size_t stride = (size + align - 1) / align * align;
+            pools.push_back(Pool{type, stride, align});
+            return pools.back();
+        }
+
+        static constexpr size_t maxSlab = 1 << 16;
+
+        size_t firstSlab;
+        std::vector<Pool> pools;
+        std::vector<Slab> slabs;
+        std::vector<std::pair<void*, void (*)(void*)>> destructors;
+        ArenaStats stats;
+    };
+
+    size_t firstSlab;
+    std::shared_ptr<Storage> storage;
+};
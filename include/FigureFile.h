@@ -0,0 +1,269 @@
+#pragma once
+
+#include "Array.h"
+#include "FigureVariant.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Binary figure collection, native byte order:
+//
+//     FigureFileHeader
+//     FigureFileEntry[count]             type and coordinate offset per figure
+//     padding up to dataOffset (64-byte aligned)
+//     coordinate blocks                  x0 y0 x1 y1 ... as T, one per figure
+//
+// Entry offsets are relative to dataOffset. A coordinate block has exactly
+// the layout of Point<T>[vertexCount], so a mapped file is used in place.
+
+enum class FigureType : uint32_t {
+    Trapezoid = 1,
+    Rhombus = 2,
+    Pentagon = 3,
+};
+
+struct FigureFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t scalar;
+    uint64_t count;
+    uint64_t tableOffset;
+    uint64_t dataOffset;
+    uint64_t dataSize;
+};
+
+struct FigureFileEntry {
+    uint32_t type;
+    uint32_t vertexCount;
+    uint64_t offset;
+};
+
+inline constexpr char figureFileMagic[8] = {'L', 'A', 'B', '4', 'F', 'I', 'G', '\0'};
+inline constexpr uint32_t figureFileVersion = 1;
+
+// Identifies the coordinate type: kind ('f', 'i' or 'u') and byte size.
+template <Scalar T>
+constexpr uint32_t scalarCode() {
+    uint32_t kind = std::is_floating_point_v<T> ? 'f' : std::is_signed_v<T> ? 'i' : 'u';
+    return (kind << 8) | static_cast<uint32_t>(sizeof(T));
+}
+
+inline FigureType figureTypeOf(std::string_view name) {
+    if (name == Trapezoid<int>::name) return FigureType::Trapezoid;
+    if (name == Rhombus<int>::name)   return FigureType::Rhombus;
+    if (name == Pentagon<int>::name)  return FigureType::Pentagon;
+    throw std::invalid_argument("Figure type has no binary encoding: " + std::string(name));
+}
+
+inline const char* figureTypeName(FigureType type) {
+    switch (type) {
+    case FigureType::Trapezoid: return Trapezoid<int>::name;
+    case FigureType::Rhombus:   return Rhombus<int>::name;
+    case FigureType::Pentagon:  return Pentagon<int>::name;
+    }
+    return "Unknown Figure";
+}
+
+inline size_t figureTypeVertices(FigureType type) {
+    switch (type) {
+    case FigureType::Trapezoid: return Trapezoid<int>::n;
+    case FigureType::Rhombus:   return Rhombus<int>::n;
+    case FigureType::Pentagon:  return Pentagon<int>::n;
+    }
+    return 0;
+}
+
+// Serializes every figure of `figures` (figures, FigureVariant or pointers
+// to Figure<T>) to `path`. The coordinate type is that of the figures.
+template <typename Elem, size_t Inline, typename Growth>
+void writeFigureFile(const std::string& path, const Array<Elem, Inline, Growth>& figures) {
+    using T = decltype(figureOf(std::declval<const Elem&>()).points()[0].x());
+    static_assert(sizeof(Point<T>) == 2 * sizeof(T) && std::is_trivially_copyable_v<Point<T>>);
+
+    const size_t count = figures.getSize();
+    std::vector<FigureFileEntry> table(count);
+
+    uint64_t dataSize = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const auto& fig = figureOf(figures[i]);
+        auto pts = fig.points();
+        table[i] = {static_cast<uint32_t>(figureTypeOf(fig.typeName())),
+                    static_cast<uint32_t>(pts.size()), dataSize};
+        dataSize += pts.size_bytes();
+    }
+
+    FigureFileHeader header{};
+    std::memcpy(header.magic, figureFileMagic, sizeof(header.magic));
+    header.version = figureFileVersion;
+    header.scalar = scalarCode<T>();
+    header.count = count;
+    header.tableOffset = sizeof(FigureFileHeader);
+    header.dataOffset = (header.tableOffset + count * sizeof(FigureFileEntry) + 63) & ~uint64_t{63};
+    header.dataSize = dataSize;
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        throw std::runtime_error("Cannot open " + path);
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(table.data()), count * sizeof(FigureFileEntry));
+
+    static constexpr char zeros[64] = {};
+    out.write(zeros, header.dataOffset - header.tableOffset - count * sizeof(FigureFileEntry));
+
+    for (size_t i = 0; i < count; ++i) {
+        auto pts = figureOf(figures[i]).points();
+        out.write(reinterpret_cast<const char*>(pts.data()), pts.size_bytes());
+    }
+
+    if (!out)
+        throw std::runtime_error("Write failed: " + path);
+}
+
+// Read-only view of one figure inside a mapped file.
+template <Scalar T>
+class MappedFigure {
+public:
+    MappedFigure(FigureType type, std::span<const Point<T>> vertices)
+        : type(type), vertices(vertices) {}
+
+    FigureType getType() const noexcept { return type; }
+    const char* typeName() const noexcept { return figureTypeName(type); }
+    std::span<const Point<T>> points() const noexcept { return vertices; }
+
+    Point<T> center() const { return polygonCenter(vertices); }
+    operator double() const { return polygonArea(vertices); }
+
+    // Copies the figure out of the mapping.
+    FigureVariant<T> materialize() const {
+        switch (type) {
+        case FigureType::Trapezoid:
+            return Trapezoid<T>(vertices[0], vertices[1], vertices[2], vertices[3]);
+        case FigureType::Rhombus:
+            return Rhombus<T>(vertices[0], vertices[1], vertices[2], vertices[3]);
+        case FigureType::Pentagon:
+            return Pentagon<T>(std::array<Point<T>, 5>{
+                vertices[0], vertices[1], vertices[2], vertices[3], vertices[4]});
+        }
+        throw std::runtime_error("Unknown figure type");
+    }
+
+private:
+    FigureType type;
+    std::span<const Point<T>> vertices;
+};
+
+// Memory-mapped figure file. Figures are exposed in place, without copying.
+template <Scalar T>
+class MappedFigureFile {
+public:
+    explicit MappedFigureFile(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("Cannot open " + path);
+
+        struct stat st {};
+        if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(FigureFileHeader))) {
+            ::close(fd);
+            throw std::runtime_error("Not a figure file: " + path);
+        }
+
+        length = static_cast<size_t>(st.st_size);
+        void* addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED)
+            throw std::runtime_error("mmap failed: " + path);
+        base = static_cast<const char*>(addr);
+
+        try {
+            validate();
+        } catch (...) {
+            ::munmap(const_cast<char*>(base), length);
+            throw;
+        }
+    }
+
+    ~MappedFigureFile() {
+        if (base)
+            ::munmap(const_cast<char*>(base), length);
+    }
+
+    MappedFigureFile(const MappedFigureFile&) = delete;
+    MappedFigureFile& operator=(const MappedFigureFile&) = delete;
+
+    MappedFigureFile(MappedFigureFile&& other) noexcept
+        : base(std::exchange(other.base, nullptr)),
+          length(std::exchange(other.length, 0)),
+          header(other.header),
+          table(other.table) {}
+
+    size_t getSize() const {
+        return header->count;
+    }
+
+    MappedFigure<T> operator[](size_t index) const {
+        if (index >= header->count)
+            throw std::out_of_range("Index out of range");
+
+        const FigureFileEntry& e = table[index];
+        return MappedFigure<T>(static_cast<FigureType>(e.type),
+                               std::span<const Point<T>>(data(e.offset), e.vertexCount));
+    }
+
+private:
+    const Point<T>* data(uint64_t offset) const {
+        return reinterpret_cast<const Point<T>*>(base + header->dataOffset + offset);
+    }
+
+    void validate() {
+        header = reinterpret_cast<const FigureFileHeader*>(base);
+
+        if (std::memcmp(header->magic, figureFileMagic, sizeof(header->magic)) != 0)
+            throw std::runtime_error("Bad figure file magic");
+        if (header->version != figureFileVersion)
+            throw std::runtime_error("Unsupported figure file version");
+        if (header->scalar != scalarCode<T>())
+            throw std::runtime_error("Figure file scalar type mismatch");
+
+        if (header->tableOffset > length ||
+            header->count > (length - header->tableOffset) / sizeof(FigureFileEntry))
+            throw std::runtime_error("Corrupt figure file layout");
+
+        uint64_t tableEnd = header->tableOffset + header->count * sizeof(FigureFileEntry);
+        if (header->tableOffset % alignof(FigureFileEntry) || tableEnd > header->dataOffset ||
+            header->dataOffset % alignof(Point<T>) || header->dataOffset > length ||
+            header->dataSize > length - header->dataOffset)
+            throw std::runtime_error("Corrupt figure file layout");
+
+        table = reinterpret_cast<const FigureFileEntry*>(base + header->tableOffset);
+
+        for (uint64_t i = 0; i < header->count; ++i) {
+            const FigureFileEntry& e = table[i];
+            auto type = static_cast<FigureType>(e.type);
+            if (figureTypeVertices(type) == 0 || e.vertexCount != figureTypeVertices(type))
+                throw std::runtime_error("Corrupt figure file entry");
+            if (e.offset % sizeof(Point<T>) || e.offset > header->dataSize ||
+                e.vertexCount > (header->dataSize - e.offset) / sizeof(Point<T>))
+                throw std::runtime_error("Corrupt figure file entry");
+        }
+    }
+
+private:
+    const char* base = nullptr;
+    size_t length = 0;
+    const FigureFileHeader* header = nullptr;
+    const FigureFileEntry* table = nullptr;
+};
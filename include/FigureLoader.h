@@ -0,0 +1,176 @@
+#pragma once
+
+#include "Array.h"
+#include "Trapezoid.h"
+#include "Rhombus.h"
+#include "Pentagon.h"
+
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Text format, one figure per line:
+//
+//     <Type> x0 y0 x1 y1 ...
+//
+// where <Type> is Trapezoid, Rhombus or Pentagon followed by 2 * n numbers.
+// Blank lines and lines starting with '#' are skipped.
+
+struct LoadError {
+    size_t line;
+    std::string message;
+};
+
+struct LoadResult {
+    size_t figures = 0;
+    size_t lines = 0;
+    std::vector<LoadError> errors;
+
+    bool ok() const {
+        return errors.empty();
+    }
+};
+
+// Bulk loader: reads the input in large blocks and parses coordinates with
+// std::from_chars, without going through iostream formatted extraction.
+template <Scalar T>
+class FigureLoader {
+public:
+    explicit FigureLoader(size_t blockSize = 1 << 20)
+        : buffer(blockSize ? blockSize : 1) {}
+
+    template <typename Elem, size_t Inline, typename Growth>
+    LoadResult load(std::istream& in, Array<Elem, Inline, Growth>& out) {
+        LoadResult result;
+        size_t before = out.getSize();
+
+        forEachLine(in, [&](std::string_view line) {
+            ++result.lines;
+            if (const char* err = parseLine(line, out))
+                result.errors.push_back({result.lines, err});
+        });
+
+        result.figures = out.getSize() - before;
+        return result;
+    }
+
+    template <typename Elem, size_t Inline, typename Growth>
+    LoadResult loadFile(const std::string& path, Array<Elem, Inline, Growth>& out) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+            throw std::runtime_error("Cannot open " + path);
+        return load(in, out);
+    }
+
+    // Parses one record and appends it to `out`. Returns nullptr on success
+    // (or for a blank/comment line), otherwise a description of the problem.
+    template <typename Elem, size_t Inline, typename Growth>
+    static const char* parseLine(std::string_view line, Array<Elem, Inline, Growth>& out) {
+        const char* p = line.data();
+        const char* end = p + line.size();
+
+        skipSpaces(p, end);
+        if (p == end || *p == '#')
+            return nullptr;
+
+        const char* tagStart = p;
+        while (p != end && *p != ' ' && *p != '\t')
+            ++p;
+        std::string_view tag(tagStart, p - tagStart);
+
+        if (tag == Trapezoid<T>::name)
+            return parseFigure<Trapezoid<T>>(p, end, out);
+        if (tag == Rhombus<T>::name)
+            return parseFigure<Rhombus<T>>(p, end, out);
+        if (tag == Pentagon<T>::name)
+            return parseFigure<Pentagon<T>>(p, end, out);
+
+        return "unknown figure type";
+    }
+
+    // Calls fn(line) for every line of `in`, without the line terminator.
+    template <typename Fn>
+    void forEachLine(std::istream& in, Fn&& fn) {
+        size_t carry = 0;
+
+        while (true) {
+            if (carry == buffer.size())
+                buffer.resize(buffer.size() * 2);
+
+            size_t got = static_cast<size_t>(
+                in.rdbuf()->sgetn(buffer.data() + carry, buffer.size() - carry));
+            const char* p = buffer.data();
+            const char* end = p + carry + got;
+
+            while (const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p))) {
+                fn(trimCr(p, nl));
+                p = nl + 1;
+            }
+
+            carry = end - p;
+            if (!got) {
+                if (carry)
+                    fn(trimCr(p, end));
+                return;
+            }
+
+            std::memmove(buffer.data(), p, carry);
+        }
+    }
+
+private:
+    template <typename Fig, typename Elem, size_t Inline, typename Growth>
+    static const char* parseFigure(const char* p, const char* end, Array<Elem, Inline, Growth>& out) {
+        std::array<Point<T>, Fig::n> pts;
+
+        for (auto& pt : pts) {
+            T x, y;
+            if (!parseNumber(p, end, x) || !parseNumber(p, end, y))
+                return "expected a number";
+            pt = Point<T>(x, y);
+        }
+
+        skipSpaces(p, end);
+        if (p != end)
+            return "unexpected trailing characters";
+
+        if constexpr (std::is_constructible_v<Elem, Fig&&>)
+            out.emplace(Fig(pts));
+        else if constexpr (std::is_constructible_v<Elem, std::shared_ptr<Fig>>)
+            out.emplace(std::make_shared<Fig>(pts));
+        else
+            return "figure type not accepted by this container";
+
+        return nullptr;
+    }
+
+    static bool parseNumber(const char*& p, const char* end, T& value) {
+        skipSpaces(p, end);
+        auto [next, ec] = std::from_chars(p, end, value);
+        if (ec != std::errc() || (next != end && *next != ' ' && *next != '\t'))
+            return false;
+        p = next;
+        return true;
+    }
+
+    static void skipSpaces(const char*& p, const char* end) {
+        while (p != end && (*p == ' ' || *p == '\t'))
+            ++p;
+    }
+
+    static std::string_view trimCr(const char* begin, const char* end) {
+        if (end != begin && end[-1] == '\r')
+            --end;
+        return std::string_view(begin, end - begin);
+    }
+
+private:
+    std::vector<char> buffer;
+};
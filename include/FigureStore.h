@@ -0,0 +1,243 @@
+#pragma once
+
+#include "Polygon.h"
+
+#include <array>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Columnar (structure-of-arrays) storage for figures with N vertices.
+// Coordinate k of every figure lives in xs[k] / ys[k], so the area and
+// center kernels stream through contiguous memory across figures.
+template <Scalar T, size_t N>
+class FigureStore {
+    static_assert(N >= 3, "FigureStore needs at least 3 vertices");
+
+public:
+    FigureStore() = default;
+
+    void reserve(size_t count) {
+        for (size_t k = 0; k < N; ++k) {
+            xs[k].reserve(count);
+            ys[k].reserve(count);
+        }
+    }
+
+    template <typename Derived>
+    void add(const Polygon<T, N, Derived>& fig) {
+        append(fig.points());
+    }
+
+    void add(const Figure<T>& fig) {
+        auto pts = fig.points();
+        if (pts.size() != N)
+            throw std::invalid_argument("Figure vertex count does not match store");
+        append(pts);
+    }
+
+    Point<T> vertex(size_t index, size_t k) const {
+        if (index >= size || k >= N)
+            throw std::out_of_range("Index out of range");
+        return Point<T>(xs[k][index], ys[k][index]);
+    }
+
+    std::vector<double> areas() const {
+        std::vector<double> out(size);
+        computeAreas(out.data());
+        return out;
+    }
+
+    std::vector<Point<T>> centers() const {
+        std::vector<T> sumX(size, T{0}), sumY(size, T{0});
+
+        for (size_t k = 0; k < N; ++k) {
+            const T* x = xs[k].data();
+            const T* y = ys[k].data();
+            for (size_t i = 0; i < size; ++i) {
+                sumX[i] += x[i];
+                sumY[i] += y[i];
+            }
+        }
+
+        std::vector<Point<T>> out;
+        out.reserve(size);
+        for (size_t i = 0; i < size; ++i)
+            out.emplace_back(sumX[i] / static_cast<T>(N), sumY[i] / static_cast<T>(N));
+        return out;
+    }
+
+    double totalArea() const {
+        std::vector<double> a = areas();
+
+        double total = 0.0;
+        for (double v : a)
+            total += v;
+        return total;
+    }
+
+    // Appends the indices of the figures that contain `p` (boundary
+    // included), in increasing order.
+    void containing(const Point<T>& p, std::vector<size_t>& out) const {
+        size_t i = 0;
+
+        if constexpr (std::is_same_v<T, double>) {
+#if defined(__AVX2__)
+            const __m256d px = _mm256_set1_pd(p.x()), py = _mm256_set1_pd(p.y());
+            const __m256d zero = _mm256_setzero_pd();
+            for (; i + 4 <= size; i += 4) {
+                __m256d inside = zero, onEdge = zero;
+                for (size_t k = 0; k < N; ++k) {
+                    // Edge a -> b with a = vertex k - 1, as in polygonContains().
+                    size_t j = k ? k - 1 : N - 1;
+                    __m256d ax = _mm256_loadu_pd(xs[j].data() + i);
+                    __m256d ay = _mm256_loadu_pd(ys[j].data() + i);
+                    __m256d bx = _mm256_loadu_pd(xs[k].data() + i);
+                    __m256d by = _mm256_loadu_pd(ys[k].data() + i);
+
+                    __m256d cross = _mm256_sub_pd(_mm256_mul_pd(_mm256_sub_pd(bx, ax), _mm256_sub_pd(py, ay)),
+                                                  _mm256_mul_pd(_mm256_sub_pd(by, ay), _mm256_sub_pd(px, ax)));
+                    __m256d straddle = _mm256_xor_pd(_mm256_cmp_pd(ay, py, _CMP_GT_OQ),
+                                                     _mm256_cmp_pd(by, py, _CMP_GT_OQ));
+                    __m256d up = _mm256_cmp_pd(by, ay, _CMP_GT_OQ);
+                    __m256d side = _mm256_or_pd(_mm256_and_pd(up, _mm256_cmp_pd(cross, zero, _CMP_GT_OQ)),
+                                                _mm256_andnot_pd(up, _mm256_cmp_pd(cross, zero, _CMP_LT_OQ)));
+                    inside = _mm256_xor_pd(inside, _mm256_and_pd(straddle, side));
+
+                    __m256d inX = _mm256_and_pd(_mm256_cmp_pd(_mm256_min_pd(ax, bx), px, _CMP_LE_OQ),
+                                                _mm256_cmp_pd(px, _mm256_max_pd(ax, bx), _CMP_LE_OQ));
+                    __m256d inY = _mm256_and_pd(_mm256_cmp_pd(_mm256_min_pd(ay, by), py, _CMP_LE_OQ),
+                                                _mm256_cmp_pd(py, _mm256_max_pd(ay, by), _CMP_LE_OQ));
+                    onEdge = _mm256_or_pd(onEdge, _mm256_and_pd(_mm256_cmp_pd(cross, zero, _CMP_EQ_OQ),
+                                                                _mm256_and_pd(inX, inY)));
+                }
+                int mask = _mm256_movemask_pd(_mm256_or_pd(inside, onEdge));
+                for (size_t l = 0; l < 4; ++l)
+                    if (mask >> l & 1)
+                        out.push_back(i + l);
+            }
+#elif defined(__SSE2__)
+            const __m128d px = _mm_set1_pd(p.x()), py = _mm_set1_pd(p.y());
+            const __m128d zero = _mm_setzero_pd();
+            for (; i + 2 <= size; i += 2) {
+                __m128d inside = zero, onEdge = zero;
+                for (size_t k = 0; k < N; ++k) {
+                    size_t j = k ? k - 1 : N - 1;
+                    __m128d ax = _mm_loadu_pd(xs[j].data() + i);
+                    __m128d ay = _mm_loadu_pd(ys[j].data() + i);
+                    __m128d bx = _mm_loadu_pd(xs[k].data() + i);
+                    __m128d by = _mm_loadu_pd(ys[k].data() + i);
+
+                    __m128d cross = _mm_sub_pd(_mm_mul_pd(_mm_sub_pd(bx, ax), _mm_sub_pd(py, ay)),
+                                               _mm_mul_pd(_mm_sub_pd(by, ay), _mm_sub_pd(px, ax)));
+                    __m128d straddle = _mm_xor_pd(_mm_cmpgt_pd(ay, py), _mm_cmpgt_pd(by, py));
+                    __m128d up = _mm_cmpgt_pd(by, ay);
+                    __m128d side = _mm_or_pd(_mm_and_pd(up, _mm_cmpgt_pd(cross, zero)),
+                                             _mm_andnot_pd(up, _mm_cmplt_pd(cross, zero)));
+                    inside = _mm_xor_pd(inside, _mm_and_pd(straddle, side));
+
+                    __m128d inX = _mm_and_pd(_mm_cmple_pd(_mm_min_pd(ax, bx), px),
+                                             _mm_cmple_pd(px, _mm_max_pd(ax, bx)));
+                    __m128d inY = _mm_and_pd(_mm_cmple_pd(_mm_min_pd(ay, by), py),
+                                             _mm_cmple_pd(py, _mm_max_pd(ay, by)));
+                    onEdge = _mm_or_pd(onEdge, _mm_and_pd(_mm_cmpeq_pd(cross, zero), _mm_and_pd(inX, inY)));
+                }
+                int mask = _mm_movemask_pd(_mm_or_pd(inside, onEdge));
+                if (mask & 1)
+                    out.push_back(i);
+                if (mask & 2)
+                    out.push_back(i + 1);
+            }
+#endif
+        }
+
+        for (; i < size; ++i) {
+            std::array<Point<T>, N> pts;
+            for (size_t k = 0; k < N; ++k)
+                pts[k] = Point<T>(xs[k][i], ys[k][i]);
+            if (polygonContains<T>(pts, p))
+                out.push_back(i);
+        }
+    }
+
+    size_t getSize() const {
+        return size;
+    }
+
+private:
+    void append(std::span<const Point<T>> pts) {
+        for (size_t k = 0; k < N; ++k) {
+            xs[k].push_back(pts[k].x());
+            ys[k].push_back(pts[k].y());
+        }
+        ++size;
+    }
+
+    static constexpr size_t next(size_t k) {
+        return k + 1 == N ? 0 : k + 1;
+    }
+
+    double areaAt(size_t i) const {
+        using Acc = ProductAcc<T>;
+        Acc twice{0};
+        for (size_t k = 0; k < N; ++k) {
+            size_t j = next(k);
+            twice += static_cast<Acc>(xs[k][i]) * static_cast<Acc>(ys[j][i])
+                   - static_cast<Acc>(xs[j][i]) * static_cast<Acc>(ys[k][i]);
+        }
+        if (twice < 0)
+            twice = -twice;
+        return static_cast<double>(twice) / 2.0;
+    }
+
+    void computeAreas(double* out) const {
+        size_t i = 0;
+
+        if constexpr (std::is_same_v<T, double>) {
+#if defined(__AVX2__)
+            const __m256d signMask = _mm256_set1_pd(-0.0);
+            const __m256d half = _mm256_set1_pd(0.5);
+            for (; i + 4 <= size; i += 4) {
+                __m256d acc = _mm256_setzero_pd();
+                for (size_t k = 0; k < N; ++k) {
+                    size_t j = next(k);
+                    __m256d xk = _mm256_loadu_pd(xs[k].data() + i);
+                    __m256d yk = _mm256_loadu_pd(ys[k].data() + i);
+                    __m256d xj = _mm256_loadu_pd(xs[j].data() + i);
+                    __m256d yj = _mm256_loadu_pd(ys[j].data() + i);
+                    acc = _mm256_add_pd(acc, _mm256_sub_pd(_mm256_mul_pd(xk, yj),
+                                                           _mm256_mul_pd(xj, yk)));
+                }
+                _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_andnot_pd(signMask, acc), half));
+            }
+#elif defined(__SSE2__)
+            const __m128d signMask = _mm_set1_pd(-0.0);
+            const __m128d half = _mm_set1_pd(0.5);
+            for (; i + 2 <= size; i += 2) {
+                __m128d acc = _mm_setzero_pd();
+                for (size_t k = 0; k < N; ++k) {
+                    size_t j = next(k);
+                    __m128d xk = _mm_loadu_pd(xs[k].data() + i);
+                    __m128d yk = _mm_loadu_pd(ys[k].data() + i);
+                    __m128d xj = _mm_loadu_pd(xs[j].data() + i);
+                    __m128d yj = _mm_loadu_pd(ys[j].data() + i);
+                    acc = _mm_add_pd(acc, _mm_sub_pd(_mm_mul_pd(xk, yj),
+                                                     _mm_mul_pd(xj, yk)));
+                }
+                _mm_storeu_pd(out + i, _mm_mul_pd(_mm_andnot_pd(signMask, acc), half));
+            }
+#endif
+        }
+
+        for (; i < size; ++i)
+            out[i] = areaAt(i);
+    }
+
+private:
+    std::array<std::vector<T>, N> xs;
+    std::array<std::vector<T>, N> ys;
+    size_t size = 0;
+};
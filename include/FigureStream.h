@@ -0,0 +1,139 @@
+#pragma once
+
+#include "FigureLoader.h"
+#include "FigureVariant.h"
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A bounded slice of the input: at most chunkSize lines worth of figures
+// and the errors found on those lines.
+template <Scalar T>
+struct FigureChunk {
+    Array<FigureVariant<T>> figures;
+    std::vector<LoadError> errors;
+    size_t firstIndex = 0;    // index of figures[0] in the whole stream
+};
+
+// Reads figure records in fixed-size chunks. While the caller processes one
+// chunk, the next one is parsed on a background thread into a second
+// buffer; the two buffers are reused, so memory stays constant regardless
+// of input size.
+template <Scalar T>
+class FigureStream {
+public:
+    explicit FigureStream(std::istream& in, size_t chunkSize = 4096)
+        : in(in), chunkSize(chunkSize ? chunkSize : 1) {
+        for (auto& c : chunks)
+            c.figures.reserve(this->chunkSize);
+    }
+
+    // Calls onChunk(const FigureChunk<T>&) for every chunk, in input order.
+    // Returns the total number of figures read.
+    template <typename OnChunk>
+    size_t run(OnChunk&& onChunk) {
+        std::thread producer([this] { produce(); });
+
+        size_t total = 0;
+        size_t slot = 0;
+        try {
+            while (true) {
+                std::unique_lock lock(mutex);
+                changed.wait(lock, [&] { return ready[slot] || finished; });
+                if (!ready[slot])
+                    break;
+                lock.unlock();
+
+                total += chunks[slot].figures.getSize();
+                onChunk(std::as_const(chunks[slot]));
+
+                lock.lock();
+                ready[slot] = false;
+                changed.notify_all();
+                slot ^= 1;
+            }
+        } catch (...) {
+            stop();
+            producer.join();
+            throw;
+        }
+
+        producer.join();
+        if (failure)
+            std::rethrow_exception(failure);
+        return total;
+    }
+
+private:
+    struct Cancelled {};
+
+    void produce() {
+        size_t slot = 0;
+        size_t lines = 0;
+        size_t line = 0;
+        size_t index = 0;
+
+        auto publish = [&] {
+            std::unique_lock lock(mutex);
+            ready[slot] = true;
+            changed.notify_all();
+
+            slot ^= 1;
+            changed.wait(lock, [&] { return !ready[slot] || cancelled; });
+            if (cancelled)
+                throw Cancelled{};
+            lock.unlock();
+
+            chunks[slot].figures.clear();
+            chunks[slot].errors.clear();
+            chunks[slot].firstIndex = index;
+            lines = 0;
+        };
+
+        try {
+            loader.forEachLine(in, [&](std::string_view text) {
+                ++line;
+                auto& chunk = chunks[slot];
+                if (const char* err = FigureLoader<T>::parseLine(text, chunk.figures))
+                    chunk.errors.push_back({line, err});
+                index = chunk.firstIndex + chunk.figures.getSize();
+
+                if (++lines == chunkSize)
+                    publish();
+            });
+
+            if (lines)
+                publish();
+        } catch (const Cancelled&) {
+        } catch (...) {
+            failure = std::current_exception();
+        }
+
+        std::lock_guard lock(mutex);
+        finished = true;
+        changed.notify_all();
+    }
+
+    void stop() {
+        std::lock_guard lock(mutex);
+        cancelled = true;
+        changed.notify_all();
+    }
+
+private:
+    std::istream& in;
+    size_t chunkSize;
+    FigureLoader<T> loader{1 << 16};
+
+    FigureChunk<T> chunks[2];
+    bool ready[2] = {false, false};
+    bool finished = false;
+    bool cancelled = false;
+    std::exception_ptr failure;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "Trapezoid.h"
+#include "Rhombus.h"
+#include "Pentagon.h"
+
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+// Value-semantic closed set of figures. Dispatch goes through std::visit on
+// concrete (final) types, and type identity is the variant index, so no
+// vtable lookups, dynamic_cast or shared_ptr refcounts are involved.
+template <Scalar T>
+class FigureVariant {
+public:
+    using Storage = std::variant<Trapezoid<T>, Rhombus<T>, Pentagon<T>>;
+
+    FigureVariant() = default;
+
+    template <typename F>
+        requires std::is_constructible_v<Storage, F&&>
+                 && (!std::is_same_v<std::remove_cvref_t<F>, FigureVariant>)
+    FigureVariant(F&& fig)
+        : value(std::forward<F>(fig)) {}
+
+    size_t index() const noexcept {
+        return value.index();
+    }
+
+    const char* typeName() const noexcept {
+        return visit([](const auto& f) { return std::remove_cvref_t<decltype(f)>::name; });
+    }
+
+    template <typename F>
+    bool holds() const noexcept {
+        return std::holds_alternative<F>(value);
+    }
+
+    template <typename F>
+    const F* getIf() const noexcept {
+        return std::get_if<F>(&value);
+    }
+
+    template <typename Visitor>
+    decltype(auto) visit(Visitor&& vis) const {
+        return std::visit(std::forward<Visitor>(vis), value);
+    }
+
+    template <typename Visitor>
+    decltype(auto) visit(Visitor&& vis) {
+        return std::visit(std::forward<Visitor>(vis), value);
+    }
+
+    Point<T> center() const {
+        return visit([](const auto& f) { return f.center(); });
+    }
+
+    operator double() const {
+        return visit([](const auto& f) { return static_cast<double>(f); });
+    }
+
+    BoundingBox<T> boundingBox() const {
+        return visit([](const auto& f) { return f.boundingBox(); });
+    }
+
+    bool contains(const Point<T>& p) const {
+        return visit([&](const auto& f) { return f.contains(p); });
+    }
+
+    std::span<const Point<T>> points() const {
+        return visit([](const auto& f) { return f.points(); });
+    }
+
+    std::uint64_t hash() const {
+        return visit([](const auto& f) { return f.hash(); });
+    }
+
+    void transform(const AffineTransform& m) {
+        visit([&](auto& f) { f.transform(m); });
+    }
+
+    bool operator==(const FigureVariant& other) const {
+        if (value.index() != other.value.index())
+            return false;
+
+        return visit([&](const auto& f) {
+            using F = std::remove_cvref_t<decltype(f)>;
+            return f.getVertices() == std::get<F>(other.value).getVertices();
+        });
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const FigureVariant& fig) {
+        fig.visit([&](const auto& f) { os << f; });
+        return os;
+    }
+
+    friend std::istream& operator>>(std::istream& is, FigureVariant& fig) {
+        fig.visit([&](auto& f) { is >> f; });
+        return is;
+    }
+
+private:
+    Storage value;
+};
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "Point.h"
+
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+// Stable 64-bit hashing for figures: the same figure hashes to the same
+// value in every run and on every build, unlike std::hash.
+
+// splitmix64 finalizer.
+constexpr std::uint64_t hashMix(std::uint64_t x) noexcept {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+constexpr std::uint64_t hashCombine(std::uint64_t seed, std::uint64_t value) noexcept {
+    return hashMix(seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2)));
+}
+
+// FNV-1a over a NUL-terminated string (type tags).
+constexpr std::uint64_t hashString(const char* s) noexcept {
+    std::uint64_t h = 0xcbf29ce484222325ULL;
+    for (; *s; ++s) {
+        h ^= static_cast<unsigned char>(*s);
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+// Values that compare equal hash equally (0.0 and -0.0 included).
+template <Scalar T>
+std::uint64_t hashScalar(T v) noexcept {
+    if constexpr (std::is_floating_point_v<T>) {
+        double d = (v == 0) ? 0.0 : static_cast<double>(v);
+        return std::bit_cast<std::uint64_t>(d);
+    } else {
+        return static_cast<std::uint64_t>(v);
+    }
+}
+
+template <Scalar T>
+std::uint64_t hashPoints(const char* tag, std::span<const Point<T>> pts) noexcept {
+    std::uint64_t h = hashString(tag);
+    for (const Point<T>& p : pts) {
+        h = hashCombine(h, hashScalar(p.x()));
+        h = hashCombine(h, hashScalar(p.y()));
+    }
+    return h;
+}
+
+// Open-addressing set of indices keyed by hash, sized for `count` entries
+// at load factor <= 1/2.
+class HashTable {
+public:
+    explicit HashTable(size_t count)
+        : slots(std::bit_ceil(2 * count + 2), empty), mask(slots.size() - 1) {}
+
+    void insert(size_t id, std::uint64_t h) {
+        size_t s = h & mask;
+        while (slots[s] != empty)
+            s = (s + 1) & mask;
+        slots[s] = id;
+    }
+
+    // First stored id with hash h (looked up in `hashes`) for which
+    // equal(id) holds, or npos.
+    template <typename Equal>
+    size_t find(std::uint64_t h, const std::vector<std::uint64_t>& hashes, Equal equal) const {
+        for (size_t s = h & mask; slots[s] != npos; s = (s + 1) & mask)
+            if (hashes[slots[s]] == h && equal(slots[s]))
+                return slots[s];
+        return npos;
+    }
+
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+private:
+    static constexpr size_t empty = npos;
+
+    std::vector<size_t> slots;
+    size_t mask;
+};
+
+// Indices [0, count) grouped into `parts` partitions by the top bits of
+// their hash, ascending within each partition: partition k holds
+// ids[start[k] .. start[k + 1]). `parts` must be a power of two.
+struct HashPartitions {
+    std::vector<std::uint64_t> hashes;
+    std::vector<size_t> start;
+    std::vector<size_t> ids;
+
+    size_t partitions() const {
+        return start.size() - 1;
+    }
+
+    static HashPartitions build(std::vector<std::uint64_t> hashes, size_t parts) {
+        HashPartitions p;
+        const int shift = 64 - std::countr_zero(parts);
+        auto partOf = [&](std::uint64_t h) {
+            return parts == 1 ? size_t{0} : static_cast<size_t>(h >> shift);
+        };
+
+        p.start.assign(parts + 1, 0);
+        for (std::uint64_t h : hashes)
+            ++p.start[partOf(h) + 1];
+        for (size_t k = 0; k < parts; ++k)
+            p.start[k + 1] += p.start[k];
+
+        p.ids.resize(hashes.size());
+        std::vector<size_t> fill(p.start.begin(), p.start.end() - 1);
+        for (size_t i = 0; i < hashes.size(); ++i)
+            p.ids[fill[partOf(hashes[i])]++] = i;
+
+        p.hashes = std::move(hashes);
+        return p;
+    }
+};
@@ -0,0 +1,236 @@
+#pragma once
+
+#include "Array.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+// Static 2-d tree over figure centers for nearest-neighbour and radius
+// queries. Nodes are stored implicitly (the median of every range sits in
+// the middle of it), coordinates as double in separate columns. Searches
+// compare squared distances; the sqrt is taken only for returned results.
+template <Scalar T>
+class KdTree {
+public:
+    struct Neighbor {
+        size_t id;          // index of the center the tree was built from
+        double distance;
+
+        bool operator==(const Neighbor&) const = default;
+    };
+
+    KdTree() = default;
+
+    explicit KdTree(std::span<const Point<T>> centers) {
+        const size_t n = centers.size();
+        std::vector<size_t> order(n);
+        for (size_t i = 0; i < n; ++i)
+            order[i] = i;
+
+        axis.assign(n, 0);
+        buildRange(centers, order, 0, n);
+
+        xs.resize(n);
+        ys.resize(n);
+        ids = std::move(order);
+        for (size_t i = 0; i < n; ++i) {
+            xs[i] = static_cast<double>(centers[ids[i]].x());
+            ys[i] = static_cast<double>(centers[ids[i]].y());
+        }
+    }
+
+    // Tree over the centers of `figures`; ids are Array indices.
+    template <typename Elem, size_t Inline, typename Growth>
+    static KdTree build(const Array<Elem, Inline, Growth>& figures) {
+        std::vector<Point<T>> centers;
+        centers.reserve(figures.getSize());
+        for (size_t i = 0; i < figures.getSize(); ++i)
+            centers.push_back(figureOf(figures[i]).center());
+        return KdTree(centers);
+    }
+
+    size_t getSize() const {
+        return ids.size();
+    }
+
+    // Up to k closest centers, nearest first (ties by id).
+    std::vector<Neighbor> nearest(const Point<T>& probe, size_t k) const {
+        std::vector<Neighbor> heap;
+        nearestInto(probe, k, heap);
+        return heap;
+    }
+
+    // Centers within `radius` of `probe` (inclusive), nearest first.
+    std::vector<Neighbor> within(const Point<T>& probe, double radius) const {
+        std::vector<Neighbor> out;
+        withinInto(probe, radius, out);
+        return out;
+    }
+
+    // Batched kNN: row i of the result holds the min(k, getSize()) nearest
+    // centers of probes[i]. Probes are split into fixed blocks across
+    // `threads` threads (0 = hardware concurrency).
+    std::vector<Neighbor> nearest(std::span<const Point<T>> probes, size_t k,
+                                  size_t threads = 0) const {
+        const size_t row = std::min(k, getSize());
+        std::vector<Neighbor> out(probes.size() * row);
+
+        forEachBlock(probes.size(), threads, [&](size_t first, size_t last) {
+            std::vector<Neighbor> heap;
+            heap.reserve(row);
+            for (size_t i = first; i < last; ++i) {
+                nearestInto(probes[i], k, heap);
+                std::copy(heap.begin(), heap.end(), out.begin() + i * row);
+            }
+        });
+        return out;
+    }
+
+    // Batched radius query, one result list per probe.
+    std::vector<std::vector<Neighbor>> within(std::span<const Point<T>> probes, double radius,
+                                              size_t threads = 0) const {
+        std::vector<std::vector<Neighbor>> out(probes.size());
+
+        forEachBlock(probes.size(), threads, [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i)
+                withinInto(probes[i], radius, out[i]);
+        });
+        return out;
+    }
+
+private:
+    static constexpr size_t leafSize = 8;
+    static constexpr size_t probeBlock = 1024;
+
+    template <typename F>
+    static void forEachBlock(size_t count, size_t threads, F&& fn) {
+        size_t blocks = (count + probeBlock - 1) / probeBlock;
+        parallelFor(blocks, threads, [&](size_t b) {
+            fn(b * probeBlock, std::min(count, (b + 1) * probeBlock));
+        });
+    }
+
+    // Orders by squared distance, then id, so results are deterministic.
+    static bool closer(const Neighbor& a, const Neighbor& b) {
+        return a.distance < b.distance || (a.distance == b.distance && a.id < b.id);
+    }
+
+    // Splits [lo, hi) at its median along the wider axis, recursively.
+    void buildRange(std::span<const Point<T>> pts, std::vector<size_t>& order, size_t lo, size_t hi) {
+        if (hi - lo <= leafSize)
+            return;
+
+        double minX = std::numeric_limits<double>::infinity(), maxX = -minX;
+        double minY = minX, maxY = -minX;
+        for (size_t i = lo; i < hi; ++i) {
+            double x = static_cast<double>(pts[order[i]].x());
+            double y = static_cast<double>(pts[order[i]].y());
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+        }
+
+        const size_t mid = lo + (hi - lo) / 2;
+        const std::uint8_t d = (maxY - minY > maxX - minX) ? 1 : 0;
+        axis[mid] = d;
+
+        std::nth_element(order.begin() + lo, order.begin() + mid, order.begin() + hi,
+                         [&](size_t a, size_t b) {
+                             return d ? pts[a].y() < pts[b].y() : pts[a].x() < pts[b].x();
+                         });
+
+        buildRange(pts, order, lo, mid);
+        buildRange(pts, order, mid + 1, hi);
+    }
+
+    double squaredDistance(size_t node, double px, double py) const {
+        double dx = xs[node] - px;
+        double dy = ys[node] - py;
+        return dx * dx + dy * dy;
+    }
+
+    // Visits every node whose subtree may hold a point within sqrt(bound())
+    // of (px, py); `bound` is re-read after each visit so kNN can shrink it.
+    template <typename Visit, typename Bound>
+    void search(size_t lo, size_t hi, double px, double py, Visit& visit, Bound& bound) const {
+        if (hi - lo <= leafSize) {
+            for (size_t i = lo; i < hi; ++i)
+                visit(i, squaredDistance(i, px, py));
+            return;
+        }
+
+        const size_t mid = lo + (hi - lo) / 2;
+        visit(mid, squaredDistance(mid, px, py));
+
+        double diff = axis[mid] ? py - ys[mid] : px - xs[mid];
+        if (diff < 0) {
+            search(lo, mid, px, py, visit, bound);
+            if (diff * diff <= bound())
+                search(mid + 1, hi, px, py, visit, bound);
+        } else {
+            search(mid + 1, hi, px, py, visit, bound);
+            if (diff * diff <= bound())
+                search(lo, mid, px, py, visit, bound);
+        }
+    }
+
+    // kNN with a max-heap of the k best candidates (distances squared until
+    // the end). Reuses `heap`'s storage.
+    void nearestInto(const Point<T>& probe, size_t k, std::vector<Neighbor>& heap) const {
+        heap.clear();
+        if (!k || ids.empty())
+            return;
+
+        auto visit = [&](size_t node, double d2) {
+            Neighbor cand{ids[node], d2};
+            if (heap.size() < k) {
+                heap.push_back(cand);
+                std::push_heap(heap.begin(), heap.end(), closer);
+            } else if (closer(cand, heap.front())) {
+                std::pop_heap(heap.begin(), heap.end(), closer);
+                heap.back() = cand;
+                std::push_heap(heap.begin(), heap.end(), closer);
+            }
+        };
+        auto bound = [&] {
+            return heap.size() < k ? std::numeric_limits<double>::infinity() : heap.front().distance;
+        };
+
+        search(0, ids.size(), static_cast<double>(probe.x()), static_cast<double>(probe.y()), visit, bound);
+
+        std::sort_heap(heap.begin(), heap.end(), closer);
+        for (Neighbor& nb : heap)
+            nb.distance = std::sqrt(nb.distance);
+    }
+
+    void withinInto(const Point<T>& probe, double radius, std::vector<Neighbor>& out) const {
+        out.clear();
+        if (ids.empty() || !(radius >= 0))
+            return;
+
+        const double r2 = radius * radius;
+        auto visit = [&](size_t node, double d2) {
+            if (d2 <= r2)
+                out.push_back({ids[node], d2});
+        };
+        auto bound = [&] { return r2; };
+
+        search(0, ids.size(), static_cast<double>(probe.x()), static_cast<double>(probe.y()), visit, bound);
+
+        std::sort(out.begin(), out.end(), closer);
+        for (Neighbor& nb : out)
+            nb.distance = std::sqrt(nb.distance);
+    }
+
+private:
+    std::vector<double> xs;
+    std::vector<double> ys;
+    std::vector<size_t> ids;
+    std::vector<std::uint8_t> axis;     // split axis of each inner node (0 = x)
+};
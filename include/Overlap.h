@@ -0,0 +1,118 @@
+#pragma once
+
+#include "Array.h"
+#include "Parallel.h"
+#include "Polygon.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+// Pair of Array indices, first < second.
+using FigurePair = std::pair<size_t, size_t>;
+
+// All pairs of figures in `figures` that overlap or touch, sorted.
+//
+// Broad phase: the plane is cut into horizontal bands sized from the data,
+// every bounding box is listed in the bands it spans, and each band runs a
+// sort-and-sweep along x (a box is compared with the boxes that start
+// before it ends and that also overlap it in y). A pair is reported only
+// from the first band both boxes share. Narrow phase: exact
+// polygonsIntersect() on the vertices. Bands are independent and are spread
+// over `threads` threads (0 = hardware concurrency); the result does not
+// depend on the thread count.
+template <typename Elem, size_t Inline, typename Growth>
+std::vector<FigurePair> overlappingPairs(const Array<Elem, Inline, Growth>& figures, size_t threads = 0) {
+    using Box = decltype(figureOf(figures[0]).boundingBox());
+    constexpr size_t block = 4096;
+
+    const size_t n = figures.getSize();
+    if (n < 2)
+        return {};
+
+    std::vector<Box> boxes(n);
+    parallelFor((n + block - 1) / block, threads, [&](size_t b) {
+        size_t last = std::min(n, (b + 1) * block);
+        for (size_t i = b * block; i < last; ++i)
+            boxes[i] = figureOf(figures[i]).boundingBox();
+    });
+
+    double minX = boxes[0].min.x(), maxX = boxes[0].max.x();
+    double minY = boxes[0].min.y(), maxY = boxes[0].max.y();
+    double meanW = 0.0, meanH = 0.0;
+    for (const Box& b : boxes) {
+        minX = std::min<double>(minX, b.min.x());
+        maxX = std::max<double>(maxX, b.max.x());
+        minY = std::min<double>(minY, b.min.y());
+        maxY = std::max<double>(maxY, b.max.y());
+        meanW += static_cast<double>(b.max.x()) - b.min.x();
+        meanH += static_cast<double>(b.max.y()) - b.min.y();
+    }
+    meanW /= n;
+    meanH /= n;
+
+    // Aim for a handful of sweep candidates per box, but keep bands at
+    // least twice the typical box height so few boxes span several bands.
+    const double height = maxY - minY, width = maxX - minX;
+    double band = std::max(2.0 * meanH, 8.0 * height * width / (n * std::max(meanW, 1e-300)));
+    size_t bands = 1;
+    if (band > 0 && std::isfinite(band))
+        bands = static_cast<size_t>(std::clamp(std::ceil(height / band), 1.0, static_cast<double>(n)));
+    band = height / bands;
+
+    auto bandOf = [&](double y) {
+        if (bands == 1 || !(y > minY))
+            return size_t{0};
+        return std::min(static_cast<size_t>((y - minY) / band), bands - 1);
+    };
+
+    // Ids per band, bucketed by counting sort.
+    std::vector<size_t> start(bands + 1, 0);
+    for (const Box& b : boxes)
+        for (size_t k = bandOf(b.min.y()), last = bandOf(b.max.y()); k <= last; ++k)
+            ++start[k + 1];
+    for (size_t k = 0; k < bands; ++k)
+        start[k + 1] += start[k];
+
+    std::vector<size_t> members(start[bands]);
+    std::vector<size_t> fill(start.begin(), start.end() - 1);
+    for (size_t i = 0; i < n; ++i)
+        for (size_t k = bandOf(boxes[i].min.y()), last = bandOf(boxes[i].max.y()); k <= last; ++k)
+            members[fill[k]++] = i;
+
+    std::vector<std::vector<FigurePair>> found(bands);
+
+    parallelFor(bands, threads, [&](size_t k) {
+        auto first = members.begin() + start[k];
+        auto last = members.begin() + start[k + 1];
+        std::sort(first, last, [&](size_t a, size_t b) {
+            return boxes[a].min.x() < boxes[b].min.x();
+        });
+
+        for (auto i = first; i != last; ++i) {
+            const Box& a = boxes[*i];
+            for (auto j = i + 1; j != last && boxes[*j].min.x() <= a.max.x(); ++j) {
+                const Box& c = boxes[*j];
+                if (c.min.y() > a.max.y() || a.min.y() > c.max.y())
+                    continue;
+                if (bandOf(std::max<double>(a.min.y(), c.min.y())) != k)
+                    continue;
+
+                if (polygonsIntersect(figureOf(figures[*i]).points(), figureOf(figures[*j]).points()))
+                    found[k].push_back(std::minmax(*i, *j));
+            }
+        }
+    });
+
+    std::vector<FigurePair> pairs;
+    size_t total = 0;
+    for (const auto& f : found)
+        total += f.size();
+    pairs.reserve(total);
+    for (const auto& f : found)
+        pairs.insert(pairs.end(), f.begin(), f.end());
+
+    std::sort(pairs.begin(), pairs.end());
+    return pairs;
+}
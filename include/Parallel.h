@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Number of worker threads to use: `requested`, or the hardware
+// concurrency when it is 0.
+inline size_t resolveThreads(size_t requested) {
+    if (requested)
+        return requested;
+    size_t hw = std::thread::hardware_concurrency();
+    return hw ? hw : 1;
+}
+
+// Process-wide set of worker threads, started on first use and grown to
+// the largest part count requested; they are joined at exit. One job runs
+// at a time: calls from different threads queue on a mutex, and calls made
+// from inside a job are expected to run inline (see insideJob()).
+class ThreadPool {
+public:
+    static ThreadPool& instance() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    // True on a thread that is currently running part of a job.
+    static bool insideJob() noexcept {
+        return inJob();
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& w : workers)
+            w.join();
+    }
+
+    // Calls task(t) for every t in [0, parts) and waits for all of them:
+    // part 0 on the calling thread, the others on workers. task must not
+    // throw.
+    template <typename F>
+    void run(size_t parts, F& task) {
+        std::lock_guard serial(runMutex);
+        {
+            std::lock_guard lock(mutex);
+            while (workers.size() + 1 < parts)
+                workers.emplace_back([this, id = workers.size()] { work(id); });
+
+            call = [](void* ctx, size_t t) { (*static_cast<F*>(ctx))(t); };
+            context = &task;
+            active = parts - 1;
+            pending = parts - 1;
+            ++generation;
+        }
+        wake.notify_all();
+
+        inJob() = true;
+        task(0);
+        inJob() = false;
+
+        std::unique_lock lock(mutex);
+        done.wait(lock, [this] { return pending == 0; });
+    }
+
+private:
+    ThreadPool() = default;
+
+    static bool& inJob() noexcept {
+        thread_local bool flag = false;
+        return flag;
+    }
+
+    // Worker `id` runs part id + 1 of every job that has that many parts.
+    void work(size_t id) {
+        inJob() = true;
+        size_t seen = 0;
+        std::unique_lock lock(mutex);
+        for (;;) {
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+            if (id >= active)
+                continue;
+
+            auto fn = call;
+            void* ctx = context;
+            lock.unlock();
+            fn(ctx, id + 1);
+            lock.lock();
+            if (--pending == 0)
+                done.notify_one();
+        }
+    }
+
+    std::mutex runMutex;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::vector<std::thread> workers;
+
+    void (*call)(void*, size_t) = nullptr;
+    void* context = nullptr;
+    size_t active = 0;          // workers taking part in the current job
+    size_t pending = 0;         // of those, still running
+    size_t generation = 0;
+    bool stopping = false;
+};
+
+// Calls fn(block) for every block in [0, blocks) using up to `threads`
+// threads of the ThreadPool. Block boundaries are chosen by the caller, so
+// results that are combined per block do not depend on the thread count.
+// Nested calls run serially on the calling thread.
+template <typename F>
+void parallelFor(size_t blocks, size_t threads, F&& fn) {
+    threads = std::min(resolveThreads(threads), blocks);
+
+    if (threads <= 1 || ThreadPool::insideJob()) {
+        for (size_t b = 0; b < blocks; ++b)
+            fn(b);
+        return;
+    }
+
+    std::vector<std::exception_ptr> errors(threads);
+    auto part = [&](size_t t) {
+        try {
+            for (size_t b = t; b < blocks; b += threads)
+                fn(b);
+        } catch (...) {
+            errors[t] = std::current_exception();
+        }
+    };
+    ThreadPool::instance().run(threads, part);
+
+    for (auto& e : errors)
+        if (e)
+            std::rethrow_exception(e);
+}
+
+// Reduces values[0..count) with a balanced binary tree of `combine` calls,
+// which keeps the rounding error of floating-point sums at O(log n). An
+// empty range reduces to V{}.
+template <typename V, typename Combine>
+V pairwiseReduce(const V* values, size_t count, Combine combine) {
+    if (count == 0)
+        return V{};
+    if (count == 1)
+        return values[0];
+
+    size_t half = count / 2;
+    return combine(pairwiseReduce(values, half, combine),
+                   pairwiseReduce(values + half, count - half, combine));
+}
+
+// Sorts [first, last) with `comp`, which must be a strict total order so
+// the result is independent of the thread count. Large ranges are sorted
+// in fixed blocks and merged pairwise, each round in parallel.
+template <typename It, typename Comp>
+void parallelSort(It first, It last, Comp comp, size_t threads = 0) {
+    constexpr size_t block = size_t{1} << 15;
+    const size_t n = static_cast<size_t>(last - first);
+    if (n <= block || resolveThreads(threads) == 1) {
+        std::sort(first, last, comp);
+        return;
+    }
+
+    const size_t blocks = (n + block - 1) / block;
+    parallelFor(blocks, threads, [&](size_t b) {
+        std::sort(first + b * block, first + std::min(n, (b + 1) * block), comp);
+    });
+
+    for (size_t width = block; width < n; width *= 2) {
+        size_t merges = (n + 2 * width - 1) / (2 * width);
+        parallelFor(merges, threads, [&](size_t m) {
+            size_t lo = m * 2 * width;
+            size_t mid = std::min(n, lo + width);
+            size_t hi = std::min(n, lo + 2 * width);
+            if (mid < hi)
+                std::inplace_merge(first + lo, first + mid, first + hi, comp);
+        });
+    }
+}
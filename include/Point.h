@@ -4,10 +4,32 @@
 #include <type_traits>
 #include <concepts>
 #include <cmath>
+#include <cstdint>
 
 template <typename T>
 concept Scalar = std::is_arithmetic_v<T>;
 
+// Accumulator for sums of coordinate products (cross products, shoelace).
+// Integers get an exact wide integer, floating point stays in hardware
+// floating point (at least double).
+template <Scalar T>
+struct ProductAccumulator {
+    using type = std::common_type_t<T, double>;
+};
+
+template <Scalar T>
+    requires std::is_integral_v<T>
+struct ProductAccumulator<T> {
+#ifdef __SIZEOF_INT128__
+    using type = std::conditional_t<(sizeof(T) <= 2), std::int64_t, __int128>;
+#else
+    using type = std::conditional_t<(sizeof(T) <= 2), std::int64_t, long double>;
+#endif
+};
+
+template <Scalar T>
+using ProductAcc = typename ProductAccumulator<T>::type;
+
 template <Scalar T>
 class Point {
 private:
@@ -44,6 +66,14 @@ public:
                static_cast<double>(_y) * static_cast<double>(other._y);
     }
 
+    // Squared distance in double; enough for ranking points, without the
+    // sqrt and the long double arithmetic of distanceTo().
+    double squaredDistanceTo(const Point& other) const noexcept {
+        double dx = static_cast<double>(_x) - static_cast<double>(other._x);
+        double dy = static_cast<double>(_y) - static_cast<double>(other._y);
+        return dx * dx + dy * dy;
+    }
+
     double distanceTo(const Point& other) const noexcept {
         long double dx = static_cast<long double>(_x) - static_cast<long double>(other._x);
         long double dy = static_cast<long double>(_y) - static_cast<long double>(other._y);
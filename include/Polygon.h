@@ -0,0 +1,261 @@
+#pragma once
+
+#include "Figure.h"
+#include "Hash.h"
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+// Shoelace area of an arbitrary closed polygon given as a vertex span.
+template <Scalar T>
+double polygonArea(std::span<const Point<T>> pts) {
+    using Acc = ProductAcc<T>;
+    if (pts.size() < 3)
+        return 0.0;
+
+    auto cross = [](const Point<T>& a, const Point<T>& b) {
+        return static_cast<Acc>(a.x()) * static_cast<Acc>(b.y())
+             - static_cast<Acc>(b.x()) * static_cast<Acc>(a.y());
+    };
+
+    Acc twice = cross(pts.back(), pts.front());
+    for (size_t i = 0; i + 1 < pts.size(); ++i)
+        twice += cross(pts[i], pts[i + 1]);
+
+    if (twice < 0)
+        twice = -twice;
+    return static_cast<double>(twice) / 2.0;
+}
+
+// Vertex mean, with the same arithmetic as Polygon::center().
+template <Scalar T>
+Point<T> polygonCenter(std::span<const Point<T>> pts) {
+    if (pts.empty())
+        return Point<T>();
+
+    T sumX{0}, sumY{0};
+    for (const auto& v : pts) {
+        sumX += v.x();
+        sumY += v.y();
+    }
+    return Point<T>(sumX / static_cast<T>(pts.size()), sumY / static_cast<T>(pts.size()));
+}
+
+// Whether p lies inside or on the boundary of the closed polygon `pts`
+// (crossing-number test; cross products are exact for integral T).
+template <Scalar T>
+bool polygonContains(std::span<const Point<T>> pts, const Point<T>& p) {
+    using Acc = ProductAcc<T>;
+    const size_t n = pts.size();
+    bool inside = false;
+
+    for (size_t i = 0, j = n - 1; i < n; j = i++) {
+        const Point<T>& a = pts[j];
+        const Point<T>& b = pts[i];
+
+        // Orientation of p relative to the edge a -> b.
+        Acc cross = (static_cast<Acc>(b.x()) - a.x()) * (static_cast<Acc>(p.y()) - a.y())
+                  - (static_cast<Acc>(b.y()) - a.y()) * (static_cast<Acc>(p.x()) - a.x());
+
+        if (cross == 0 &&
+            std::min(a.x(), b.x()) <= p.x() && p.x() <= std::max(a.x(), b.x()) &&
+            std::min(a.y(), b.y()) <= p.y() && p.y() <= std::max(a.y(), b.y()))
+            return true;
+
+        // Edge straddles the horizontal line through p and crosses it to the
+        // right of p: the sign of `cross` relative to the edge direction.
+        if ((a.y() > p.y()) != (b.y() > p.y()) && ((cross > 0) == (b.y() > a.y())))
+            inside = !inside;
+    }
+
+    return inside;
+}
+
+// Sign of the turn a -> b -> c: positive counter-clockwise, zero collinear.
+template <Scalar T>
+int orientation(const Point<T>& a, const Point<T>& b, const Point<T>& c) {
+    using Acc = ProductAcc<T>;
+    Acc cross = (static_cast<Acc>(b.x()) - a.x()) * (static_cast<Acc>(c.y()) - a.y())
+              - (static_cast<Acc>(b.y()) - a.y()) * (static_cast<Acc>(c.x()) - a.x());
+    return (cross > 0) - (cross < 0);
+}
+
+// Whether the closed segments p1p2 and q1q2 share a point.
+template <Scalar T>
+bool segmentsIntersect(const Point<T>& p1, const Point<T>& p2, const Point<T>& q1, const Point<T>& q2) {
+    // For collinear c: whether c lies within the box of a, b.
+    auto within = [](const Point<T>& a, const Point<T>& b, const Point<T>& c) {
+        return std::min(a.x(), b.x()) <= c.x() && c.x() <= std::max(a.x(), b.x()) &&
+               std::min(a.y(), b.y()) <= c.y() && c.y() <= std::max(a.y(), b.y());
+    };
+
+    int d1 = orientation(q1, q2, p1);
+    int d2 = orientation(q1, q2, p2);
+    int d3 = orientation(p1, p2, q1);
+    int d4 = orientation(p1, p2, q2);
+
+    if (d1 * d2 < 0 && d3 * d4 < 0)
+        return true;
+
+    return (d1 == 0 && within(q1, q2, p1)) || (d2 == 0 && within(q1, q2, p2)) ||
+           (d3 == 0 && within(p1, p2, q1)) || (d4 == 0 && within(p1, p2, q2));
+}
+
+// Whether two simple polygons overlap or touch: some pair of edges meets,
+// or one polygon lies entirely inside the other.
+template <Scalar T>
+bool polygonsIntersect(std::span<const Point<T>> a, std::span<const Point<T>> b) {
+    for (size_t i = 0, pi = a.size() - 1; i < a.size(); pi = i++)
+        for (size_t j = 0, pj = b.size() - 1; j < b.size(); pj = j++)
+            if (segmentsIntersect(a[pi], a[i], b[pj], b[j]))
+                return true;
+
+    return polygonContains(a, b[0]) || polygonContains(b, a[0]);
+}
+
+// Common base for every N-gon. Derived is the concrete figure (CRTP) and
+// provides `static constexpr const char* name`, used for printing and for
+// type identity in equals().
+template <Scalar T, size_t N, typename Derived>
+class Polygon : public Figure<T> {
+    static_assert(N >= 3, "Polygon needs at least 3 vertices");
+
+public:
+    static constexpr size_t n = N;
+
+    Polygon() = default;
+
+    explicit Polygon(const std::array<Point<T>, N>& verts)
+        : vertices(verts) {}
+
+    Polygon(const Polygon&) = default;
+    Polygon& operator=(const Polygon&) = default;
+
+    Polygon(Polygon&&) noexcept = default;
+    Polygon& operator=(Polygon&&) noexcept = default;
+
+    const std::array<Point<T>, N>& getVertices() const noexcept {
+        return vertices;
+    }
+
+    std::span<const Point<T>> points() const override {
+        return vertices;
+    }
+
+    const char* typeName() const override {
+        return Derived::name;
+    }
+
+    Point<T> center() const override {
+        return this->metrics().center;
+    }
+
+    operator double() const override {
+        return this->metrics().area;
+    }
+
+    BoundingBox<T> boundingBox() const override {
+        return this->metrics().box;
+    }
+
+    bool contains(const Point<T>& p) const override {
+        BoundingBox<T> b = boundingBox();
+        if (p.x() < b.min.x() || p.x() > b.max.x() || p.y() < b.min.y() || p.y() > b.max.y())
+            return false;
+        return polygonContains<T>(vertices, p);
+    }
+
+    // Shoelace over the edges (i, i + 1) plus the closing edge (N - 1, 0),
+    // unrolled at compile time. Exact for integral T.
+    ProductAcc<T> twiceSignedArea() const noexcept {
+        return [this]<size_t... I>(std::index_sequence<I...>) {
+            return (cross(vertices[I], vertices[I + 1]) + ...)
+                 + cross(vertices[N - 1], vertices[0]);
+        }(std::make_index_sequence<N - 1>{});
+    }
+
+    // Floating-point figures keep a filled cache: the area scales by
+    // |det|, the center is mapped and the box is taken from the new
+    // vertices. Integral vertices are rounded, so the cache is dropped.
+    void transform(const AffineTransform& m) override {
+        if constexpr (std::is_same_v<T, double>)
+            m.applyInPlace(vertices.data(), N);
+        else
+            for (auto& v : vertices)
+                v = m.apply(v);
+
+        if constexpr (std::is_floating_point_v<T>) {
+            this->updateCache([&](FigureCache<T>& c) {
+                c.area *= std::abs(m.det());
+                c.center = m.apply(c.center);
+                c.box = bounds();
+            });
+        } else {
+            this->invalidate();
+        }
+    }
+
+    std::uint64_t hash() const override {
+        return hashPoints<T>(Derived::name, vertices);
+    }
+
+    bool equals(const Figure<T>& other) const override {
+        const auto* d = dynamic_cast<const Derived*>(&other);
+        if (!d)
+            return false;
+
+        return vertices == d->getVertices();
+    }
+
+protected:
+    FigureCache<T> computeCache() const override {
+        FigureCache<T> c;
+
+        ProductAcc<T> twice = twiceSignedArea();
+        if (twice < 0)
+            twice = -twice;
+        c.area = static_cast<double>(twice) / 2.0;
+
+        c.center = [this]<size_t... I>(std::index_sequence<I...>) {
+            T sumX = (T{0} + ... + vertices[I].x());
+            T sumY = (T{0} + ... + vertices[I].y());
+            return Point<T>(sumX / static_cast<T>(N), sumY / static_cast<T>(N));
+        }(std::make_index_sequence<N>{});
+
+        c.box = bounds();
+        return c;
+    }
+
+    void print(std::ostream& os) const override {
+        os << Derived::name << ": ";
+        for (const auto& v : vertices)
+            os << v << " ";
+    }
+
+    void read(std::istream& is) override {
+        for (auto& v : vertices)
+            is >> v;
+    }
+
+private:
+    BoundingBox<T> bounds() const noexcept {
+        T minX = vertices[0].x(), maxX = minX;
+        T minY = vertices[0].y(), maxY = minY;
+        for (size_t i = 1; i < N; ++i) {
+            minX = std::min(minX, vertices[i].x());
+            maxX = std::max(maxX, vertices[i].x());
+            minY = std::min(minY, vertices[i].y());
+            maxY = std::max(maxY, vertices[i].y());
+        }
+        return {Point<T>(minX, minY), Point<T>(maxX, maxY)};
+    }
+
+    static ProductAcc<T> cross(const Point<T>& a, const Point<T>& b) noexcept {
+        using Acc = ProductAcc<T>;
+        return static_cast<Acc>(a.x()) * static_cast<Acc>(b.y())
+             - static_cast<Acc>(b.x()) * static_cast<Acc>(a.y());
+    }
+
+    std::array<Point<T>, N> vertices;
+};
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "Array.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Ranking queries over an Array. `key` maps a figure to a sort key (area
+// by default); keys are computed once per call into a side array, in
+// parallel for large arrays, and ties are broken by index so results are
+// stable.
+
+// Default key: the figure's area.
+struct AreaKey {
+    template <typename Fig>
+    double operator()(const Fig& fig) const {
+        return static_cast<double>(fig);
+    }
+};
+
+namespace ranking_detail {
+
+inline constexpr size_t block = 4096;
+
+// key(element i) for every i, computed in parallel blocks.
+template <typename K, typename Elem, size_t Inline, typename Growth, typename Key>
+std::vector<K> keys(const Array<Elem, Inline, Growth>& figures, Key& key, size_t threads) {
+    const size_t n = figures.getSize();
+    std::vector<K> out(n);
+    parallelFor((n + block - 1) / block, threads, [&](size_t b) {
+        size_t end = std::min(n, (b + 1) * block);
+        for (size_t i = b * block; i < end; ++i)
+            out[i] = static_cast<K>(key(figureOf(figures.uncheckedAt(i))));
+    });
+    return out;
+}
+
+// (key, index) pairs; ordering them by operator< sorts by key, then index.
+template <typename Elem, size_t Inline, typename Growth, typename Key>
+auto keyedIndices(const Array<Elem, Inline, Growth>& figures, Key& key, size_t threads) {
+    using K = std::remove_cvref_t<std::invoke_result_t<Key&, decltype(figureOf(figures.uncheckedAt(0)))>>;
+    const size_t n = figures.getSize();
+    std::vector<std::pair<K, size_t>> out(n);
+    parallelFor((n + block - 1) / block, threads, [&](size_t b) {
+        size_t end = std::min(n, (b + 1) * block);
+        for (size_t i = b * block; i < end; ++i)
+            out[i] = {key(figureOf(figures.uncheckedAt(i))), i};
+    });
+    return out;
+}
+
+}
+
+// Stable sort by ascending key.
+template <typename Elem, size_t Inline, typename Growth, typename Key = AreaKey>
+void sortBy(Array<Elem, Inline, Growth>& figures, Key key = {}, size_t threads = 0) {
+    auto keyed = ranking_detail::keyedIndices(figures, key, threads);
+    parallelSort(keyed.begin(), keyed.end(), std::less<>{}, threads);
+
+    // Elements are moved out in the new order, then moved back.
+    std::vector<Elem> sorted;
+    sorted.reserve(keyed.size());
+    for (const auto& [k, i] : keyed)
+        sorted.push_back(std::move(figures.uncheckedAt(i)));
+    std::move(sorted.begin(), sorted.end(), figures.begin());
+}
+
+// Indices of the k elements with the largest keys, largest first.
+template <typename Elem, size_t Inline, typename Growth, typename Key = AreaKey>
+std::vector<size_t> topK(const Array<Elem, Inline, Growth>& figures, size_t k, Key key = {}, size_t threads = 0) {
+    using ranking_detail::block;
+    auto keyed = ranking_detail::keyedIndices(figures, key, threads);
+    const size_t n = keyed.size();
+    k = std::min(k, n);
+
+    // Larger key first; among equal keys the lower index.
+    auto before = [](const auto& a, const auto& b) {
+        return b.first < a.first || (!(a.first < b.first) && a.second < b.second);
+    };
+
+    // Each block keeps its own k best, then the survivors are ranked.
+    size_t blocks = (n + block - 1) / block;
+    std::vector<size_t> kept(blocks);
+    parallelFor(blocks, threads, [&](size_t b) {
+        auto first = keyed.begin() + b * block;
+        auto last = keyed.begin() + std::min(n, (b + 1) * block);
+        size_t m = std::min<size_t>(k, last - first);
+        std::nth_element(first, first + m, last, before);
+        kept[b] = m;
+    });
+
+    size_t count = 0;
+    for (size_t b = 0; b < blocks; ++b) {
+        auto first = keyed.begin() + b * block;
+        count = std::move(first, first + kept[b], keyed.begin() + count) - keyed.begin();
+    }
+    std::partial_sort(keyed.begin(), keyed.begin() + k, keyed.begin() + count, before);
+
+    std::vector<size_t> out(k);
+    for (size_t i = 0; i < k; ++i)
+        out[i] = keyed[i].second;
+    return out;
+}
+
+// Key percentiles for each p in [0, 100], interpolating linearly between
+// the closest ranks.
+template <typename Elem, size_t Inline, typename Growth, typename Key = AreaKey>
+std::vector<double> percentiles(const Array<Elem, Inline, Growth>& figures, const std::vector<double>& ps,
+                                Key key = {}, size_t threads = 0) {
+    const size_t n = figures.getSize();
+    if (!n)
+        throw std::out_of_range("Array is empty");
+    for (double p : ps)
+        if (!(p >= 0.0 && p <= 100.0))
+            throw std::invalid_argument("Percentile must be in [0, 100]");
+
+    std::vector<double> values = ranking_detail::keys<double>(figures, key, threads);
+    parallelSort(values.begin(), values.end(), std::less<>{}, threads);
+
+    std::vector<double> out;
+    out.reserve(ps.size());
+    for (double p : ps) {
+        double pos = p / 100.0 * static_cast<double>(n - 1);
+        size_t lo = static_cast<size_t>(pos);
+        size_t hi = std::min(lo + 1, n - 1);
+        out.push_back(values[lo] + (values[hi] - values[lo]) * (pos - static_cast<double>(lo)));
+    }
+    return out;
+}
+
+template <typename Elem, size_t Inline, typename Growth, typename Key = AreaKey>
+double percentile(const Array<Elem, Inline, Growth>& figures, double p, Key key = {}, size_t threads = 0) {
+    return percentiles(figures, {p}, key, threads).front();
+}
+
+// Counts of keys in `buckets` equal-width buckets over [lo, hi]; hi falls
+// into the last bucket, keys outside the range are not counted.
+template <typename Elem, size_t Inline, typename Growth, typename Key = AreaKey>
+std::vector<size_t> histogram(const Array<Elem, Inline, Growth>& figures, size_t buckets, double lo, double hi,
+                              Key key = {}, size_t threads = 0) {
+    using ranking_detail::block;
+    if (!buckets || !(lo < hi))
+        throw std::invalid_argument("Histogram needs buckets and lo < hi");
+
+    const size_t n = figures.getSize();
+    const double scale = static_cast<double>(buckets) / (hi - lo);
+    size_t blocks = (n + block - 1) / block;
+    std::vector<std::vector<size_t>> partial(blocks, std::vector<size_t>(buckets, 0));
+
+    parallelFor(blocks, threads, [&](size_t b) {
+        size_t end = std::min(n, (b + 1) * block);
+        for (size_t i = b * block; i < end; ++i) {
+            double v = static_cast<double>(key(figureOf(figures.uncheckedAt(i))));
+            if (!(v >= lo && v <= hi))
+                continue;
+            size_t bucket = static_cast<size_t>((v - lo) * scale);
+            ++partial[b][std::min(bucket, buckets - 1)];
+        }
+    });
+
+    std::vector<size_t> counts(buckets, 0);
+    for (const auto& p : partial)
+        for (size_t k = 0; k < buckets; ++k)
+            counts[k] += p[k];
+    return counts;
+}
@@ -0,0 +1,268 @@
+#pragma once
+
+#include "Aggregate.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+enum class ReportFormat {
+    Text,       // same layout as Array::printAll / printCenters
+    Csv,        // index,type,area,center_x,center_y,vertices
+    JsonLines,  // one JSON object per figure
+};
+
+// Report output that formats numbers with std::to_chars into one reusable
+// buffer and hands it to the stream in large writes. Nothing is allocated
+// per record.
+class ReportWriter {
+public:
+    // Which text line to produce; CSV and JSON always write full records.
+    enum class Record {
+        Figure,   // "i: <figure> | Area = a"
+        Center,   // "i: Center = (x, y)"
+        Full,     // "i: <figure> | Area = a | Center = (x, y)"
+    };
+
+    explicit ReportWriter(std::ostream& os, ReportFormat format = ReportFormat::Text,
+                          int precision = 4, size_t bufferSize = 1 << 16)
+        : os(os), format(format), precision(precision),
+          buffer(std::max<size_t>(bufferSize, 2 * reserveBytes)) {}
+
+    ~ReportWriter() {
+        flush();
+    }
+
+    ReportWriter(const ReportWriter&) = delete;
+    ReportWriter& operator=(const ReportWriter&) = delete;
+
+    template <typename Fig>
+    void write(size_t index, const Fig& fig, Record kind = Record::Full) {
+        switch (format) {
+        case ReportFormat::Text:
+            writeText(index, fig, kind);
+            break;
+        case ReportFormat::Csv:
+            writeCsv(index, fig);
+            break;
+        case ReportFormat::JsonLines:
+            writeJson(index, fig);
+            break;
+        }
+    }
+
+    void totals(const FigureAggregate& agg) {
+        switch (format) {
+        case ReportFormat::Text:
+            put("Total Area: ");
+            putNumber(agg.totalArea);
+            put('\n');
+            break;
+        case ReportFormat::Csv:
+            break;
+        case ReportFormat::JsonLines:
+            put("{\"figures\":");
+            putNumber(agg.count);
+            put(",\"total_area\":");
+            putJsonNumber(agg.totalArea);
+            put(",\"centroid\":[");
+            putJsonNumber(agg.centroid.x());
+            put(',');
+            putJsonNumber(agg.centroid.y());
+            put("]}\n");
+            break;
+        }
+    }
+
+    void put(std::string_view text) {
+        if (text.size() > buffer.size() - used) {
+            flush();
+            if (text.size() > buffer.size()) {
+                os.write(text.data(), static_cast<std::streamsize>(text.size()));
+                return;
+            }
+        }
+        std::memcpy(buffer.data() + used, text.data(), text.size());
+        used += text.size();
+    }
+
+    void put(char c) {
+        if (used == buffer.size())
+            flush();
+        buffer[used++] = c;
+    }
+
+    // Integers verbatim, floating point in fixed notation with the
+    // configured precision.
+    template <typename V>
+        requires std::is_arithmetic_v<V>
+    void putNumber(V value) {
+        if (buffer.size() - used < reserveBytes)
+            flush();
+
+        char* first = buffer.data() + used;
+        char* last = buffer.data() + buffer.size();
+        std::to_chars_result r;
+        if constexpr (std::is_floating_point_v<V>)
+            r = std::to_chars(first, last, value, std::chars_format::fixed, precision);
+        else
+            r = std::to_chars(first, last, value);
+
+        if (r.ec != std::errc()) {
+            // Fixed notation of a huge value may not fit; fall back to
+            // the shortest round-trip form.
+            r = std::to_chars(first, last, value);
+        }
+        used = r.ptr - buffer.data();
+    }
+
+    void flush() {
+        if (used) {
+            os.write(buffer.data(), static_cast<std::streamsize>(used));
+            used = 0;
+        }
+    }
+
+private:
+    static constexpr size_t reserveBytes = 512;
+
+    template <typename V>
+    void putJsonNumber(V value) {
+        if constexpr (std::is_floating_point_v<V>) {
+            if (!std::isfinite(value)) {
+                put("null");
+                return;
+            }
+        }
+        putNumber(value);
+    }
+
+    template <typename Fig>
+    void putPoints(const Fig& fig, std::string_view open, std::string_view sep,
+                   std::string_view close, std::string_view between) {
+        bool first = true;
+        for (const auto& v : fig.points()) {
+            if (!first)
+                put(between);
+            first = false;
+            put(open);
+            putNumber(v.x());
+            put(sep);
+            putNumber(v.y());
+            put(close);
+        }
+    }
+
+    template <typename Fig>
+    void writeText(size_t index, const Fig& fig, Record kind) {
+        putNumber(index);
+        put(": ");
+
+        if (kind != Record::Center) {
+            put(fig.typeName());
+            put(": ");
+            for (const auto& v : fig.points()) {
+                put('(');
+                putNumber(v.x());
+                put(", ");
+                putNumber(v.y());
+                put(") ");
+            }
+            put(" | Area = ");
+            putNumber(static_cast<double>(fig));
+            if (kind == Record::Figure) {
+                put('\n');
+                return;
+            }
+            put(" | ");
+        }
+
+        auto c = fig.center();
+        put("Center = (");
+        putNumber(c.x());
+        put(", ");
+        putNumber(c.y());
+        put(")\n");
+    }
+
+    template <typename Fig>
+    void writeCsv(size_t index, const Fig& fig) {
+        if (!headerWritten) {
+            put("index,type,area,center_x,center_y,vertices\n");
+            headerWritten = true;
+        }
+
+        auto c = fig.center();
+        putNumber(index);
+        put(',');
+        put(fig.typeName());
+        put(',');
+        putNumber(static_cast<double>(fig));
+        put(',');
+        putNumber(c.x());
+        put(',');
+        putNumber(c.y());
+        put(",\"");
+        putPoints(fig, "", " ", "", " ");
+        put("\"\n");
+    }
+
+    template <typename Fig>
+    void writeJson(size_t index, const Fig& fig) {
+        auto c = fig.center();
+        put("{\"index\":");
+        putNumber(index);
+        put(",\"type\":\"");
+        put(fig.typeName());
+        put("\",\"area\":");
+        putJsonNumber(static_cast<double>(fig));
+        put(",\"center\":[");
+        putJsonNumber(c.x());
+        put(',');
+        putJsonNumber(c.y());
+        put("],\"vertices\":[");
+        putPoints(fig, "[", ",", "]", ",");
+        put("]}\n");
+    }
+
+private:
+    std::ostream& os;
+    ReportFormat format;
+    int precision;
+    std::vector<char> buffer;
+    size_t used = 0;
+    bool headerWritten = false;
+};
+
+// Buffered variants of Array::printAll / printCenters / printTotalArea.
+template <typename Elem, size_t Inline, typename Growth>
+void printAll(const Array<Elem, Inline, Growth>& figures, ReportWriter& out) {
+    if (!figures.getSize())
+        throw std::out_of_range("Array is empty");
+
+    for (size_t i = 0; i < figures.getSize(); ++i)
+        out.write(i, figureOf(figures.uncheckedAt(i)), ReportWriter::Record::Figure);
+}
+
+template <typename Elem, size_t Inline, typename Growth>
+void printCenters(const Array<Elem, Inline, Growth>& figures, ReportWriter& out) {
+    if (!figures.getSize())
+        throw std::out_of_range("Array is empty");
+
+    for (size_t i = 0; i < figures.getSize(); ++i)
+        out.write(i, figureOf(figures.uncheckedAt(i)), ReportWriter::Record::Center);
+}
+
+template <typename Elem, size_t Inline, typename Growth>
+void printTotalArea(const Array<Elem, Inline, Growth>& figures, ReportWriter& out) {
+    if (!figures.getSize())
+        throw std::out_of_range("Array is empty");
+
+    out.totals(aggregate(figures));
+}
@@ -0,0 +1,236 @@
+#pragma once
+
+#include "Aggregate.h"
+#include "Array.h"
+#include "Polygon.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Uniform grid over figure bounding boxes. Each figure id (its index in the
+// Array the grid mirrors) is stored in every cell its box overlaps; figures
+// covering too many cells go to a separate list that every query scans.
+// Window and point queries touch only the cells they overlap, so their cost
+// depends on the local density, not on the collection size.
+template <Scalar T>
+class SpatialGrid {
+public:
+    using Box = BoundingBox<T>;
+
+    SpatialGrid(const BoundingBox<double>& extent, double cellSize)
+        : origin(extent.min), cell(cellSize > 0 ? cellSize : 1.0) {
+        double width = extent.max.x() - extent.min.x();
+        double height = extent.max.y() - extent.min.y();
+
+        // Grow cells rather than let the axis limit pile the far end of
+        // the extent into the last column or row.
+        cell = std::max({cell, width / maxCellsPerAxis, height / maxCellsPerAxis});
+        cols = cellCount(width);
+        rows = cellCount(height);
+        cells.resize(cols * rows);
+    }
+
+    // Builds a grid for `figures`, sizing cells from the data density:
+    // about `perCell` figures per cell, and cells no smaller than the mean
+    // figure extent.
+    template <typename Elem, size_t Inline, typename Growth>
+    static SpatialGrid build(const Array<Elem, Inline, Growth>& figures, double perCell = 2.0) {
+        const size_t n = figures.getSize();
+        if (!n)
+            return SpatialGrid({{0, 0}, {1, 1}}, 1.0);
+
+        FigureAggregate agg = aggregate(figures);
+        double width = std::max(agg.max.x() - agg.min.x(), 1e-9);
+        double height = std::max(agg.max.y() - agg.min.y(), 1e-9);
+
+        double meanSize = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            Box b = figureOf(figures[i]).boundingBox();
+            meanSize += std::max(static_cast<double>(b.max.x()) - b.min.x(),
+                                 static_cast<double>(b.max.y()) - b.min.y());
+        }
+        meanSize /= n;
+
+        double cellSize = std::max(std::sqrt(width * height * perCell / n), meanSize);
+        SpatialGrid grid({agg.min, agg.max}, cellSize);
+
+        for (size_t i = 0; i < n; ++i)
+            grid.insert(i, figureOf(figures[i]).boundingBox());
+        return grid;
+    }
+
+    void insert(size_t id, const Box& box) {
+        if (id >= boxes.size()) {
+            boxes.resize(id + 1);
+            present.resize(id + 1, false);
+        }
+        if (present[id])
+            throw std::invalid_argument("Id already in the grid");
+
+        boxes[id] = box;
+        present[id] = true;
+        ++count;
+
+        forEachCell(box, [&](std::vector<size_t>& c) { c.push_back(id); });
+    }
+
+    void erase(size_t id) {
+        checkPresent(id);
+        forEachCell(boxes[id], [&](std::vector<size_t>& c) {
+            auto it = std::find(c.begin(), c.end(), id);
+            *it = c.back();
+            c.pop_back();
+        });
+        present[id] = false;
+        --count;
+    }
+
+    // Renames `from` to `to`, e.g. after an element was moved in the Array.
+    void relabel(size_t from, size_t to) {
+        checkPresent(from);
+        if (to >= boxes.size()) {
+            boxes.resize(to + 1);
+            present.resize(to + 1, false);
+        }
+        if (present[to])
+            throw std::invalid_argument("Id already in the grid");
+
+        forEachCell(boxes[from], [&](std::vector<size_t>& c) {
+            *std::find(c.begin(), c.end(), from) = to;
+        });
+        boxes[to] = boxes[from];
+        present[to] = true;
+        present[from] = false;
+    }
+
+    // Appends to the Array and indexes the new element.
+    template <typename Elem, size_t Inline, typename Growth, typename U>
+    void add(Array<Elem, Inline, Growth>& figures, U&& elem) {
+        figures.add(std::forward<U>(elem));
+        size_t id = figures.getSize() - 1;
+        insert(id, figureOf(figures[id]).boundingBox());
+    }
+
+    // Array::swapRemove with the matching index update.
+    template <typename Elem, size_t Inline, typename Growth>
+    void swapRemove(Array<Elem, Inline, Growth>& figures, size_t index) {
+        size_t last = figures.getSize() - 1;
+        erase(index);
+        if (index != last)
+            relabel(last, index);
+        figures.swapRemove(index);
+    }
+
+    // Ids whose bounding box overlaps `window` (boundaries included).
+    void query(const Box& window, std::vector<size_t>& out) const {
+        auto [x0, y0] = cellOf(window.min);
+        auto [x1, y1] = cellOf(window.max);
+
+        for (size_t cy = y0; cy <= y1; ++cy) {
+            for (size_t cx = x0; cx <= x1; ++cx) {
+                for (size_t id : cells[cy * cols + cx]) {
+                    // A box spanning several cells is reported only from the
+                    // first cell shared by the box and the window.
+                    auto [bx, by] = cellOf(boxes[id].min);
+                    if (cx == std::max(bx, x0) && cy == std::max(by, y0) && overlaps(boxes[id], window))
+                        out.push_back(id);
+                }
+            }
+        }
+
+        for (size_t id : oversized)
+            if (overlaps(boxes[id], window))
+                out.push_back(id);
+    }
+
+    // Ids of the figures that contain `p` (exact test against vertices).
+    template <typename Elem, size_t Inline, typename Growth>
+    void containing(const Array<Elem, Inline, Growth>& figures, const Point<T>& p, std::vector<size_t>& out) const {
+        auto test = [&](size_t id) {
+            if (overlaps(boxes[id], Box{p, p}) && polygonContains(figureOf(figures[id]).points(), p))
+                out.push_back(id);
+        };
+
+        auto [cx, cy] = cellOf(p);
+        for (size_t id : cells[cy * cols + cx])
+            test(id);
+        for (size_t id : oversized)
+            test(id);
+    }
+
+    size_t getSize() const {
+        return count;
+    }
+
+    double getCellSize() const {
+        return cell;
+    }
+
+    // Number of ids stored in the cell containing `p`.
+    size_t cellLoad(const Point<T>& p) const {
+        auto [cx, cy] = cellOf(p);
+        return cells[cy * cols + cx].size();
+    }
+
+private:
+    // Figures overlapping more cells than this are kept in `oversized`.
+    static constexpr size_t maxCellsPerFigure = 64;
+    static constexpr double maxCellsPerAxis = 4096.0;
+
+    size_t cellCount(double length) const {
+        double c = std::ceil(length / cell);
+        return static_cast<size_t>(std::clamp(c, 1.0, maxCellsPerAxis));
+    }
+
+    // Cell of a point; points outside the extent clamp to the border cells.
+    std::pair<size_t, size_t> cellOf(const Point<T>& p) const {
+        auto index = [&](double v, double o, size_t limit) {
+            double c = std::floor((v - o) / cell);
+            if (!(c > 0))
+                return size_t{0};
+            return std::min(static_cast<size_t>(std::min(c, 1e18)), limit - 1);
+        };
+        return {index(static_cast<double>(p.x()), origin.x(), cols),
+                index(static_cast<double>(p.y()), origin.y(), rows)};
+    }
+
+    static bool overlaps(const Box& a, const Box& b) {
+        return a.min.x() <= b.max.x() && b.min.x() <= a.max.x() &&
+               a.min.y() <= b.max.y() && b.min.y() <= a.max.y();
+    }
+
+    template <typename Fn>
+    void forEachCell(const Box& box, Fn&& fn) {
+        auto [x0, y0] = cellOf(box.min);
+        auto [x1, y1] = cellOf(box.max);
+
+        if ((x1 - x0 + 1) * (y1 - y0 + 1) > maxCellsPerFigure) {
+            fn(oversized);
+            return;
+        }
+
+        for (size_t cy = y0; cy <= y1; ++cy)
+            for (size_t cx = x0; cx <= x1; ++cx)
+                fn(cells[cy * cols + cx]);
+    }
+
+    void checkPresent(size_t id) const {
+        if (id >= present.size() || !present[id])
+            throw std::out_of_range("Id not in the grid");
+    }
+
+private:
+    Point<double> origin;
+    double cell;
+    size_t cols = 1;
+    size_t rows = 1;
+
+    std::vector<std::vector<size_t>> cells;
+    std::vector<size_t> oversized;
+    std::vector<Box> boxes;
+    std::vector<bool> present;
+    size_t count = 0;
+};
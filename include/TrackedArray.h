@@ -0,0 +1,138 @@
+#pragma once
+
+#include "Array.h"
+
+#include <utility>
+
+// Array of figures that keeps a running total area and sum of centers, so
+// totalArea() and meanCenter() are O(1). All mutation goes through this
+// class: add/remove update the totals, and in-place changes go through the
+// Edit handle returned by edit(), which re-reads the element when it is
+// released.
+template <typename T>
+class TrackedArray {
+public:
+    class Edit {
+    public:
+        Edit(const Edit&) = delete;
+        Edit& operator=(const Edit&) = delete;
+
+        ~Edit() {
+            owner.include(owner.items[index]);
+        }
+
+        T& operator*() const { return owner.items[index]; }
+        T* operator->() const { return &owner.items[index]; }
+
+    private:
+        friend class TrackedArray;
+
+        Edit(TrackedArray& owner, size_t index)
+            : owner(owner), index(index) {
+            owner.exclude(owner.items[index]);
+        }
+
+        TrackedArray& owner;
+        size_t index;
+    };
+
+    TrackedArray() = default;
+
+    template <typename U>
+    void add(U&& elem) {
+        include(items.emplace(std::forward<U>(elem)));
+    }
+
+    template <typename... Args>
+    const T& emplace(Args&&... args) {
+        T& elem = items.emplace(std::forward<Args>(args)...);
+        include(elem);
+        return elem;
+    }
+
+    void remove(size_t index) {
+        exclude(items[index]);
+        items.remove(index);
+    }
+
+    void swapRemove(size_t index) {
+        exclude(items[index]);
+        items.swapRemove(index);
+    }
+
+    template <typename U>
+    void set(size_t index, U&& elem) {
+        exclude(items[index]);
+        items[index] = std::forward<U>(elem);
+        include(items[index]);
+    }
+
+    // Write handle for element `index`; totals are updated when it goes
+    // out of scope.
+    Edit edit(size_t index) {
+        return Edit(*this, index);
+    }
+
+    const T& operator[](size_t index) const {
+        return items[index];
+    }
+
+    size_t getSize() const {
+        return items.getSize();
+    }
+
+    void reserve(size_t count) {
+        items.reserve(count);
+    }
+
+    double totalArea() const {
+        return area.value();
+    }
+
+    Point<double> centerSum() const {
+        return Point<double>(centerX.value(), centerY.value());
+    }
+
+    Point<double> meanCenter() const {
+        size_t n = items.getSize();
+        if (!n)
+            return Point<double>();
+        return Point<double>(centerX.value() / n, centerY.value() / n);
+    }
+
+    // Rebuilds the running totals from scratch.
+    void recompute() {
+        area = {};
+        centerX = {};
+        centerY = {};
+        for (size_t i = 0; i < items.getSize(); ++i)
+            include(items[i]);
+    }
+
+    const Array<T>& getItems() const {
+        return items;
+    }
+
+private:
+    void include(const T& elem) {
+        account(elem, 1.0);
+    }
+
+    void exclude(const T& elem) {
+        account(elem, -1.0);
+    }
+
+    void account(const T& elem, double sign) {
+        const auto& fig = figureOf(elem);
+        auto c = fig.center();
+        area.add(sign * static_cast<double>(fig));
+        centerX.add(sign * static_cast<double>(c.x()));
+        centerY.add(sign * static_cast<double>(c.y()));
+    }
+
+private:
+    Array<T> items;
+    CompensatedSum area;
+    CompensatedSum centerX;
+    CompensatedSum centerY;
+};
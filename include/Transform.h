@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Affine.h"
+#include "Array.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+// Applies `m` in place to every figure of `figures`, in fixed blocks across
+// `threads` threads (0 = hardware concurrency). When the elements are
+// pointers, the distinct figures are collected first, so a figure shared by
+// several elements is transformed once and by one thread only.
+template <typename Elem, size_t Inline, typename Growth>
+void transformAll(Array<Elem, Inline, Growth>& figures, const AffineTransform& m, size_t threads = 0) {
+    constexpr size_t block = 4096;
+    auto run = [&](size_t count, auto&& figureAt) {
+        parallelFor((count + block - 1) / block, threads, [&](size_t b) {
+            size_t end = std::min(count, (b + 1) * block);
+            for (size_t i = b * block; i < end; ++i)
+                figureAt(i).transform(m);
+        });
+    };
+
+    if constexpr (requires { *figures.uncheckedAt(0); }) {
+        using Fig = std::remove_reference_t<decltype(figureOf(figures.uncheckedAt(0)))>;
+
+        std::vector<Fig*> distinct;
+        distinct.reserve(figures.getSize());
+        for (auto& elem : figures)
+            distinct.push_back(&figureOf(elem));
+        parallelSort(distinct.begin(), distinct.end(), std::less<Fig*>{}, threads);
+        distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+
+        run(distinct.size(), [&](size_t i) -> Fig& { return *distinct[i]; });
+    } else {
+        run(figures.getSize(), [&](size_t i) -> Elem& { return figures.uncheckedAt(i); });
+    }
+}
@@ -3,37 +3,94 @@
 #include <iomanip>
 #include <array>
 #include <string>
+#include <fstream>
 
 #include "Array.h"
 #include "Trapezoid.h"
 #include "Rhombus.h"
 #include "Pentagon.h"
+#include "FigureVariant.h"
+#include "FigureStream.h"
+#include "FigureArena.h"
+#include "ReportWriter.h"
 
 // Трапеция:       0 0   4 0   3 2   1 2
 // Ромб:           0 0   2 1   4 0   2 -1
 // Пятиугольник:   0 0   1 0   2 1   1 2   0 1
 
+// Потоковый режим: Lab4 --stream [--csv | --json] [файл]
+// Записи вида "Trapezoid x0 y0 ... x3 y3" читаются порциями фиксированного
+// размера; память не зависит от размера входа.
 template <typename T>
-std::string typeName(const Figure<T>& f) {
-    if (dynamic_cast<const Trapezoid<T>*>(&f)) return "Trapezoid";
-    if (dynamic_cast<const Rhombus<T>*>(&f))   return "Rhombus";
-    if (dynamic_cast<const Pentagon<T>*>(&f))  return "Pentagon";
-    return "Unknown Figure";
+int runStream(std::istream& in, ReportFormat format) {
+    AggregatePartial totals;
+    size_t errors = 0;
+
+    ReportWriter out(std::cout, format, 4, 1 << 20);
+    FigureStream<T> stream(in);
+    stream.run([&](const FigureChunk<T>& chunk) {
+        if (!chunk.errors.empty()) {
+            out.flush();
+            for (const auto& e : chunk.errors)
+                std::cerr << "Line " << e.line << ": " << e.message << "\n";
+            errors += chunk.errors.size();
+        }
+
+        for (size_t i = 0; i < chunk.figures.getSize(); ++i) {
+            out.write(chunk.firstIndex + i, chunk.figures[i]);
+            totals.add(chunk.figures[i]);
+        }
+    });
+
+    FigureAggregate result = totals.result();
+    if (format == ReportFormat::Text) {
+        out.put("\nFigures: ");
+        out.putNumber(result.count);
+        out.put('\n');
+    }
+    out.totals(result);
+    out.flush();
+
+    return errors ? 1 : 0;
 }
 
-int main() {
+int main(int argc, char** argv) {
     using I = int;
+
+    if (argc > 1 && std::string(argv[1]) == "--stream") {
+        ReportFormat format = ReportFormat::Text;
+        int arg = 2;
+        if (arg < argc && std::string(argv[arg]) == "--csv") {
+            format = ReportFormat::Csv;
+            ++arg;
+        } else if (arg < argc && std::string(argv[arg]) == "--json") {
+            format = ReportFormat::JsonLines;
+            ++arg;
+        }
+
+        if (arg < argc) {
+            std::ifstream file(argv[arg], std::ios::binary);
+            if (!file) {
+                std::cerr << "Cannot open " << argv[arg] << "\n";
+                return 1;
+            }
+            return runStream<I>(file, format);
+        }
+        return runStream<I>(std::cin, format);
+    }
+
     std::cout << std::fixed << std::setprecision(2);
 
     /* ================= Polymorphic container ================= */
 
+    FigureArena arena;
     Array<std::shared_ptr<Figure<I>>> figures;
 
-    auto t = std::make_shared<Trapezoid<I>>(
+    auto t = arena.share<Trapezoid<I>>(
         Point<I>(0, 0), Point<I>(4, 0), Point<I>(3, 2), Point<I>(0, 2)
     );
 
-    auto r = std::make_shared<Rhombus<I>>(
+    auto r = arena.share<Rhombus<I>>(
         Point<I>(0, 0), Point<I>(1, 1), Point<I>(2, 0), Point<I>(1, -1)
     );
 
@@ -42,7 +99,7 @@ int main() {
         Point<I>(1, 2), Point<I>(0, 1)
     };
 
-    auto p = std::make_shared<Pentagon<I>>(pentpts);
+    auto p = arena.share<Pentagon<I>>(pentpts);
 
     figures.add(t);
     figures.add(r);
@@ -50,7 +107,7 @@ int main() {
 
     std::cout << "\n=== Input vertex coordinates for polymorphic figures ===\n";
     for (size_t i = 0; i < figures.getSize(); ++i) {
-        std::cout << "\nFigure " << i << " (" << typeName(*figures[i]) << "):\n";
+        std::cout << "\nFigure " << i << " (" << figures[i]->typeName() << "):\n";
         std::cin >> *figures[i];
     }
 
@@ -109,6 +166,22 @@ int main() {
     trapezoids.remove(0);
     std::cout << "Size after removal = " << trapezoids.getSize() << "\n";
 
+    /* ================= Variant container ================= */
+
+    Array<FigureVariant<I>> variants;
+
+    variants.add(Trapezoid<I>(Point<I>(0, 0), Point<I>(4, 0), Point<I>(3, 2), Point<I>(0, 2)));
+    variants.add(Rhombus<I>(Point<I>(0, 0), Point<I>(1, 1), Point<I>(2, 0), Point<I>(1, -1)));
+    variants.add(Pentagon<I>(pentpts));
+
+    std::cout << "\n=== Variant container ===\n";
+    for (size_t i = 0; i < variants.getSize(); ++i) {
+        auto c = variants[i].center();
+        std::cout << variants[i].typeName() << " " << i
+                  << " | Surface = " << double(variants[i])
+                  << " | Center = (" << c.x() << ", " << c.y() << ")\n";
+    }
+
     /* ================= Out of range test ================= */
 
     std::cout << "\n=== Index out of bounds test ===\n";
@@ -1,15 +1,87 @@
 #include "gtest/gtest.h"
 
 #include "../include/Point.h"
+#include "../include/Polygon.h"
 #include "../include/Trapezoid.h"
 #include "../include/Rhombus.h"
 #include "../include/Pentagon.h"
 #include "../include/Array.h"
+#include "../include/Aggregate.h"
+#include "../include/TrackedArray.h"
+#include "../include/FigureStore.h"
+#include "../include/FigureVariant.h"
+#include "../include/FigureLoader.h"
+#include "../include/FigureFile.h"
+#include "../include/FigureStream.h"
+#include "../include/ReportWriter.h"
+#include "../include/FigureArena.h"
+#include "../include/ConcurrentArray.h"
+#include "../include/SpatialGrid.h"
+#include "../include/KdTree.h"
+#include "../include/Containment.h"
+#include "../include/Dedupe.h"
+#include "../include/Overlap.h"
+#include "../include/Parallel.h"
+#include "../include/Ranking.h"
+#include "../include/Transform.h"
 
 #include <sstream>
 #include <cmath>
 #include <memory>
 #include <array>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <algorithm>
+#include <random>
+#include <numeric>
+#include <ranges>
+#include <set>
+#include <mutex>
+#ifdef LAB4_HAS_TBB
+#include <execution>
+#endif
+
+// ================== ALLOCATION COUNTER ==================
+static std::atomic<size_t> g_allocations{0};
+
+// Every replaceable form goes through malloc/free, so news and deletes
+// of any kind pair up.
+static void* countedAlloc(std::size_t size, std::size_t align = 0) {
+    ++g_allocations;
+    size = size ? size : 1;
+    void* p = align ? std::aligned_alloc(align, (size + align - 1) / align * align)
+                    : std::malloc(size);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(std::size_t size) { return countedAlloc(size); }
+void* operator new[](std::size_t size) { return countedAlloc(size); }
+void* operator new(std::size_t size, std::align_val_t al) { return countedAlloc(size, static_cast<std::size_t>(al)); }
+void* operator new[](std::size_t size, std::align_val_t al) { return countedAlloc(size, static_cast<std::size_t>(al)); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try { return countedAlloc(size); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try { return countedAlloc(size); } catch (...) { return nullptr; }
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
 
 // ================== TRAPEZOID ==================
 TEST(TrapezoidTest, AreaAndCenter) {
@@ -59,6 +131,45 @@ TEST(TrapezoidTest, InputOutput) {
     EXPECT_NE(out.str().find("("), std::string::npos);
 }
 
+TEST(TrapezoidTest, NoPerVertexAllocations) {
+    size_t before = g_allocations.load();
+
+    Trapezoid<int> t({0,0}, {4,0}, {3,2}, {0,2});
+    Trapezoid<int> copy = t;
+    Trapezoid<int> moved = std::move(copy);
+    Rhombus<int> r({0,0}, {1,1}, {2,0}, {1,-1});
+    Pentagon<int> p(std::array<Point<int>,5>{{{0,0}, {1,0}, {2,1}, {1,2}, {0,1}}});
+
+    EXPECT_EQ(g_allocations.load(), before);
+    EXPECT_TRUE(t == moved);
+    EXPECT_NEAR(double(r) + double(p), 2.0 + 2.5, 1e-6);
+}
+
+TEST(TrapezoidTest, CachedMetrics) {
+    Trapezoid<int> t({0,0}, {4,0}, {3,2}, {0,2});
+    EXPECT_FALSE(t.isCached());
+
+    EXPECT_NEAR(double(t), 7.0, 1e-9);
+    EXPECT_TRUE(t.isCached());
+    EXPECT_EQ(t.boundingBox(), (BoundingBox<int>{{0,0}, {4,2}}));
+
+    Trapezoid<int> copy = t;
+    EXPECT_TRUE(copy.isCached());
+
+    std::stringstream in("0 0 2 0 2 2 0 2");
+    in >> t;
+    EXPECT_FALSE(t.isCached());
+    EXPECT_NEAR(double(t), 4.0, 1e-9);
+    EXPECT_EQ(t.center(), Point<int>(1, 1));
+
+    copy = Trapezoid<int>({0,0}, {1,0}, {1,1}, {0,1});
+    EXPECT_FALSE(copy.isCached());
+    EXPECT_NEAR(double(copy), 1.0, 1e-9);
+
+    EXPECT_GE(Figure<int>::cacheOverhead(), sizeof(FigureCache<int>));
+    EXPECT_EQ(sizeof(Trapezoid<int>), sizeof(Figure<int>) + 4 * sizeof(Point<int>));
+}
+
 // ================== RHOMBUS ==================
 TEST(RhombusTest, AreaCenterEquality) {
     Rhombus<int> r({0,0}, {1,1}, {2,0}, {1,-1});
@@ -168,6 +279,79 @@ TEST(CrossTypeTest, PentagonTrapezoid) {
     EXPECT_FALSE(p == t);
 }
 
+// ================== GENERIC POLYGON ==================
+template <Scalar T>
+class Hexagon : public Polygon<T, 6, Hexagon<T>> {
+public:
+    static constexpr const char* name = "Hexagon";
+    using Polygon<T, 6, Hexagon<T>>::Polygon;
+    Hexagon() = default;
+};
+
+template <Scalar T>
+class Triangle : public Polygon<T, 3, Triangle<T>> {
+public:
+    static constexpr const char* name = "Triangle";
+    using Polygon<T, 3, Triangle<T>>::Polygon;
+    Triangle() = default;
+};
+
+TEST(PolygonTest, CustomNGons) {
+    Hexagon<double> h(std::array<Point<double>,6>{{
+        {2,0}, {1,1.5}, {-1,1.5}, {-2,0}, {-1,-1.5}, {1,-1.5}
+    }});
+    EXPECT_NEAR(double(h), 9.0, 1e-9);
+    EXPECT_NEAR(h.center().x(), 0.0, 1e-9);
+    EXPECT_NEAR(h.center().y(), 0.0, 1e-9);
+
+    Triangle<int> t(std::array<Point<int>,3>{{{0,0}, {4,0}, {0,3}}});
+    EXPECT_NEAR(double(t), 6.0, 1e-9);
+
+    std::stringstream out;
+    out << t;
+    EXPECT_EQ(out.str().rfind("Triangle: ", 0), 0u);
+}
+
+TEST(PolygonTest, SameArityDifferentTypes) {
+    Trapezoid<int> t({0,0}, {1,1}, {2,0}, {1,-1});
+    Rhombus<int> r({0,0}, {1,1}, {2,0}, {1,-1});
+
+    EXPECT_FALSE(t == r);
+    EXPECT_FALSE(r == t);
+}
+
+TEST(PolygonTest, ExactIntegerArea) {
+    // Products are ~2^80, beyond the 64-bit mantissa of long double.
+    const long long B = 1LL << 40;
+    Triangle<long long> t(std::array<Point<long long>,3>{{
+        {B, B}, {B + 2, B}, {B, B + 2}
+    }});
+
+    EXPECT_EQ(t.twiceSignedArea(), 4);
+    EXPECT_EQ(double(t), 2.0);
+
+    Rhombus<unsigned> r({0,1}, {1,2}, {2,1}, {1,0});
+    EXPECT_EQ(double(r), 2.0);
+}
+
+// Vertex sums are divided by the vertex count as T, not as size_t, which
+// would turn a negative sum into a huge unsigned one.
+TEST(PolygonTest, NegativeIntegerCenter) {
+    Trapezoid<long long> t({-5,0}, {0,0}, {0,-1}, {0,-1});
+    EXPECT_EQ(t.center(), Point<long long>(-1, 0));
+
+    Rhombus<int> r({-4,-4}, {-3,-3}, {-2,-4}, {-3,-6});
+    EXPECT_EQ(r.center(), Point<int>(-3, -4));
+    EXPECT_EQ(polygonCenter(r.points()), Point<int>(-3, -4));
+
+    FigureStore<int, 4> store;
+    store.add(r);
+    store.add(Trapezoid<int>({-8,0}, {0,0}, {0,-4}, {-5,-4}));
+    auto centers = store.centers();
+    EXPECT_EQ(centers[0], Point<int>(-3, -4));
+    EXPECT_EQ(centers[1], Point<int>(-3, -2));
+}
+
 // ================== ARRAY ==================
 TEST(ArrayTest, NonPolymorphicContainer) {
     Array<Trapezoid<int>> arr;
@@ -203,6 +387,1360 @@ TEST(ArrayTest, Polymorphism) {
     EXPECT_NE(dynamic_cast<Pentagon<int>*>(arr[2].get()), nullptr);
 }
 
+TEST(ArrayTest, ReserveAndEmplaceSingleAllocation) {
+    Array<Trapezoid<int>> arr;
+    size_t before = g_allocations.load();
+
+    arr.reserve(1000);
+    for (int i = 0; i < 1000; ++i)
+        arr.emplace(Point<int>(i, 0), Point<int>(i + 4, 0), Point<int>(i + 3, 2), Point<int>(i, 2));
+
+    EXPECT_EQ(g_allocations.load() - before, 1u);
+    EXPECT_EQ(arr.getSize(), 1000u);
+    EXPECT_EQ(arr.getCapacity(), 1000u);
+    EXPECT_EQ(arr[999].center(), Point<int>(1000, 1));
+}
+
+TEST(ArrayTest, GrowthKeepsElements) {
+    Array<std::shared_ptr<Figure<int>>> arr;
+    EXPECT_EQ(arr.getCapacity(), 0u);
+
+    auto r = std::make_shared<Rhombus<int>>(
+        Point<int>(0,0), Point<int>(1,1), Point<int>(2,0), Point<int>(1,-1));
+    for (int i = 0; i < 33; ++i)
+        arr.add(r);
+
+    EXPECT_EQ(r.use_count(), 34);
+    // Growing while adding one of our own elements.
+    ASSERT_EQ(arr.getSize(), arr.getCapacity() - 31);
+    for (int i = 0; i < 31; ++i)
+        arr.add(arr[0]);
+    arr.add(arr[0]);
+    EXPECT_EQ(arr[64].get(), r.get());
+
+    arr.remove(0);
+    EXPECT_EQ(r.use_count(), 65);
+
+    Array<std::shared_ptr<Figure<int>>> moved = std::move(arr);
+    EXPECT_EQ(arr.getSize(), 0u);
+    EXPECT_EQ(moved.getSize(), 64u);
+    moved.clear();
+    EXPECT_EQ(r.use_count(), 1);
+}
+
+TEST(ArrayTest, UnorderedAndBulkRemoval) {
+    Array<Trapezoid<int>> arr;
+    for (int i = 0; i < 10; ++i)
+        arr.emplace(Point<int>(0, 0), Point<int>(i, 0), Point<int>(i, 2), Point<int>(0, 2));
+
+    // Zero-area figures are i == 0.
+    EXPECT_EQ(arr.eraseIf([](const Trapezoid<int>& t) { return double(t) == 0.0; }), 1u);
+    ASSERT_EQ(arr.getSize(), 9u);
+    EXPECT_EQ(double(arr[0]), 2.0);
+    EXPECT_EQ(double(arr[8]), 18.0);
+
+    arr.swapRemove(0);
+    ASSERT_EQ(arr.getSize(), 8u);
+    EXPECT_EQ(double(arr[0]), 18.0);
+    EXPECT_EQ(double(arr[1]), 4.0);
+
+    arr.removeRange(1, 4);
+    ASSERT_EQ(arr.getSize(), 5u);
+    EXPECT_EQ(double(arr[1]), 10.0);
+
+    arr.removeRange(2, 2);
+    EXPECT_EQ(arr.getSize(), 5u);
+    EXPECT_THROW(arr.removeRange(3, 6), std::out_of_range);
+    EXPECT_THROW(arr.swapRemove(5), std::out_of_range);
+
+    arr.swapRemove(4);
+    EXPECT_EQ(arr.getSize(), 4u);
+}
+
+TEST(ArrayTest, AggregateIsDeterministic) {
+    Array<std::shared_ptr<Figure<double>>> arr;
+    for (int i = 0; i < 20000; ++i) {
+        double s = 0.1 * i;
+        arr.add(std::make_shared<Trapezoid<double>>(
+            Point<double>(s, 0), Point<double>(s + 4, 0),
+            Point<double>(s + 3, 2), Point<double>(s, 2)));
+    }
+    arr.add(std::make_shared<Rhombus<double>>(
+        Point<double>(0,0), Point<double>(1,1), Point<double>(2,0), Point<double>(1,-1)));
+
+    FigureAggregate one = aggregate(arr, 1);
+    EXPECT_EQ(one.count, 20001u);
+    EXPECT_NEAR(one.totalArea, 20000 * 7.0 + 2.0, 1e-6);
+    EXPECT_EQ(one.min, Point<double>(0, -1));
+    EXPECT_NEAR(one.max.x(), 0.1 * 19999 + 4, 1e-9);
+    EXPECT_EQ(one.max.y(), 2.0);
+
+    for (size_t threads : {2u, 3u, 8u}) {
+        FigureAggregate many = aggregate(arr, threads);
+        EXPECT_EQ(many.totalArea, one.totalArea);
+        EXPECT_EQ(many.centroid, one.centroid);
+    }
+
+    Array<Rhombus<int>> empty;
+    EXPECT_EQ(aggregate(empty).count, 0u);
+}
+
+// ================== PARALLEL ==================
+TEST(ParallelTest, PoolThreadsAreReused) {
+    std::mutex m;
+    std::set<std::thread::id> seen;
+    for (int call = 0; call < 20; ++call) {
+        parallelFor(16, 4, [&](size_t) {
+            std::lock_guard lock(m);
+            seen.insert(std::this_thread::get_id());
+        });
+    }
+    EXPECT_LE(seen.size(), 4u);
+}
+
+TEST(ParallelTest, NestedCallsAndErrors) {
+    std::vector<int> hits(64, 0);
+    parallelFor(8, 4, [&](size_t b) {
+        parallelFor(8, 4, [&](size_t i) { ++hits[b * 8 + i]; });
+    });
+    EXPECT_EQ(std::count(hits.begin(), hits.end(), 1), 64);
+
+    EXPECT_THROW(parallelFor(8, 3, [](size_t b) {
+        if (b == 5)
+            throw std::runtime_error("block failed");
+    }), std::runtime_error);
+}
+
+TEST(ParallelTest, PairwiseReduceEmpty) {
+    std::vector<double> none;
+    EXPECT_EQ(pairwiseReduce(none.data(), 0, std::plus<>{}), 0.0);
+
+    double values[] = {1.0, 2.0, 3.0};
+    EXPECT_EQ(pairwiseReduce(values, 3, std::plus<>{}), 6.0);
+}
+
+// ================== TRACKED ARRAY ==================
+TEST(TrackedArrayTest, RunningTotals) {
+    TrackedArray<std::shared_ptr<Figure<int>>> arr;
+
+    arr.add(std::make_shared<Trapezoid<int>>(
+        Point<int>(0,0), Point<int>(4,0), Point<int>(3,2), Point<int>(0,2)));
+    arr.add(std::make_shared<Rhombus<int>>(
+        Point<int>(0,0), Point<int>(1,1), Point<int>(2,0), Point<int>(1,-1)));
+    EXPECT_DOUBLE_EQ(arr.totalArea(), 9.0);
+    EXPECT_EQ(arr.centerSum(), Point<double>(2, 1));
+
+    arr.set(1, std::make_shared<Pentagon<int>>(
+        std::array<Point<int>,5>{{{0,0}, {1,0}, {2,1}, {1,2}, {0,1}}}));
+    EXPECT_DOUBLE_EQ(arr.totalArea(), 9.5);
+
+    {
+        auto e = arr.edit(0);
+        std::stringstream in("0 0 2 0 2 2 0 2");
+        in >> **e;
+    }
+    EXPECT_DOUBLE_EQ(arr.totalArea(), 6.5);
+    EXPECT_EQ(arr.meanCenter(), Point<double>(0.5, 0.5));
+
+    arr.remove(0);
+    EXPECT_DOUBLE_EQ(arr.totalArea(), 2.5);
+    arr.swapRemove(0);
+    EXPECT_EQ(arr.getSize(), 0u);
+    EXPECT_DOUBLE_EQ(arr.totalArea(), 0.0);
+}
+
+TEST(TrackedArrayTest, NoDriftAfterChurn) {
+    TrackedArray<Trapezoid<double>> arr;
+    for (int i = 0; i < 1000; ++i) {
+        double s = 1e6 + 0.37 * i;
+        arr.emplace(Point<double>(s, 0), Point<double>(s + 4.1, 0),
+                    Point<double>(s + 3, 2.3), Point<double>(s, 2.3));
+        if (i % 3 == 0)
+            arr.swapRemove(0);
+    }
+
+    double tracked = arr.totalArea();
+    arr.recompute();
+    EXPECT_NEAR(tracked, arr.totalArea(), 1e-9 * arr.totalArea());
+    EXPECT_NEAR(tracked, aggregate(arr.getItems()).totalArea, 1e-9 * tracked);
+}
+
+// ================== FIGURE STORE ==================
+TEST(FigureStoreTest, MatchesPolymorphicPath) {
+    FigureStore<double, 4> store;
+    std::vector<std::shared_ptr<Figure<double>>> figs;
+
+    for (int i = 0; i < 11; ++i) {
+        double s = i;
+        figs.push_back(std::make_shared<Trapezoid<double>>(
+            Point<double>(s, 0), Point<double>(s + 4, 0),
+            Point<double>(s + 3, 2 + s), Point<double>(s + 1, 2 + s)));
+        figs.push_back(std::make_shared<Rhombus<double>>(
+            Point<double>(0, s), Point<double>(1, s + 1),
+            Point<double>(2, s), Point<double>(1, s - 1)));
+    }
+    for (const auto& f : figs)
+        store.add(*f);
+
+    ASSERT_EQ(store.getSize(), figs.size());
+
+    auto areas = store.areas();
+    auto centers = store.centers();
+    double total = 0;
+    for (size_t i = 0; i < figs.size(); ++i) {
+        EXPECT_NEAR(areas[i], double(*figs[i]), 1e-9);
+        EXPECT_NEAR(centers[i].x(), figs[i]->center().x(), 1e-9);
+        EXPECT_NEAR(centers[i].y(), figs[i]->center().y(), 1e-9);
+        total += double(*figs[i]);
+    }
+    EXPECT_NEAR(store.totalArea(), total, 1e-9);
+
+    std::array<Point<double>,5> pts = {{{0,0}, {1,0}, {2,1}, {1,2}, {0,1}}};
+    EXPECT_THROW(store.add(static_cast<const Figure<double>&>(Pentagon<double>(pts))),
+                 std::invalid_argument);
+}
+
+TEST(FigureStoreTest, IntegerStore) {
+    FigureStore<int, 5> store;
+    store.add(Pentagon<int>(std::array<Point<int>,5>{{{0,0}, {1,0}, {2,1}, {1,2}, {0,1}}}));
+
+    EXPECT_EQ(store.areas()[0], 2.5);
+    EXPECT_EQ(store.centers()[0], Point<int>(0, 0));
+    EXPECT_EQ(store.vertex(0, 2), Point<int>(2, 1));
+}
+
+// ================== FIGURE VARIANT ==================
+TEST(FigureVariantTest, ValueContainer) {
+    Array<FigureVariant<int>> arr;
+
+    arr.add(Trapezoid<int>({0,0}, {4,0}, {3,2}, {0,2}));
+    arr.add(Rhombus<int>({0,0}, {1,1}, {2,0}, {1,-1}));
+    arr.add(Pentagon<int>(std::array<Point<int>,5>{{{0,0}, {1,0}, {2,1}, {1,2}, {0,1}}}));
+
+    ASSERT_EQ(arr.getSize(), 3u);
+    EXPECT_TRUE(arr[0].holds<Trapezoid<int>>());
+    EXPECT_STREQ(arr[1].typeName(), "Rhombus");
+    EXPECT_NE(arr[2].getIf<Pentagon<int>>(), nullptr);
+
+    EXPECT_NEAR(double(arr[0]) + double(arr[1]) + double(arr[2]), 7.0 + 2.0 + 2.5, 1e-9);
+    EXPECT_EQ(arr[1].center(), Point<int>(1, 0));
+    EXPECT_EQ(arr[2].points().size(), 5u);
+}
+
+TEST(FigureVariantTest, EqualityUsesTag) {
+    FigureVariant<int> t = Trapezoid<int>({0,0}, {1,1}, {2,0}, {1,-1});
+    FigureVariant<int> r = Rhombus<int>({0,0}, {1,1}, {2,0}, {1,-1});
+    FigureVariant<int> r2 = Rhombus<int>({0,0}, {1,1}, {2,0}, {1,-1});
+
+    EXPECT_FALSE(t == r);
+    EXPECT_TRUE(r == r2);
+
+    std::stringstream in("0 0 2 1 4 0 2 -1");
+    in >> r2;
+    EXPECT_FALSE(r == r2);
+
+    std::stringstream out;
+    out << r2;
+    EXPECT_EQ(out.str().rfind("Rhombus: ", 0), 0u);
+}
+
+// ================== FIGURE LOADER ==================
+TEST(FigureLoaderTest, ParsesRecordsAndReportsErrors) {
+    std::stringstream in(
+        "# comment\n"
+        "Trapezoid 0 0 4 0 3 2 0 2\n"
+        "\n"
+        "Rhombus\t0 0 1 1 2 0 1 -1\r\n"
+        "Pentagon 0 0 1 0 2 1 1 2 0 1\n"
+        "Hexagon 0 0 1 1\n"
+        "Rhombus 0 0 1 1 2 0 1\n"
+        "Trapezoid 0 0 4 0 3 2 0 2 9\n"
+        "Pentagon 0 0 1 0 2 1 1 2 0 1");
+
+    Array<FigureVariant<int>> arr;
+    FigureLoader<int> loader(16);   // tiny blocks force lines across reads
+    LoadResult res = loader.load(in, arr);
+
+    EXPECT_EQ(res.lines, 9u);
+    EXPECT_EQ(res.figures, 4u);
+    ASSERT_EQ(arr.getSize(), 4u);
+    EXPECT_STREQ(arr[1].typeName(), "Rhombus");
+    EXPECT_EQ(arr[0].center(), Point<int>(1, 1));
+    EXPECT_NEAR(double(arr[2]), 2.5, 1e-9);
+
+    ASSERT_EQ(res.errors.size(), 3u);
+    EXPECT_EQ(res.errors[0].line, 6u);
+    EXPECT_EQ(res.errors[0].message, "unknown figure type");
+    EXPECT_EQ(res.errors[1].line, 7u);
+    EXPECT_EQ(res.errors[2].line, 8u);
+}
+
+TEST(FigureLoaderTest, PolymorphicAndTypedTargets) {
+    std::stringstream in("Trapezoid 0 0 4 0 3 2 0 2\nRhombus 0.5 0 1 1 2 0 1 -1\n");
+    Array<std::shared_ptr<Figure<double>>> poly;
+    EXPECT_TRUE(FigureLoader<double>().load(in, poly).ok());
+    ASSERT_EQ(poly.getSize(), 2u);
+    EXPECT_EQ(poly[1]->points()[0], Point<double>(0.5, 0));
+
+    std::stringstream in2("Trapezoid 0 0 4 0 3 2 0 2\nRhombus 0 0 1 1 2 0 1 -1\n");
+    Array<Trapezoid<double>> traps;
+    LoadResult res = FigureLoader<double>().load(in2, traps);
+    EXPECT_EQ(traps.getSize(), 1u);
+    ASSERT_EQ(res.errors.size(), 1u);
+    EXPECT_EQ(res.errors[0].line, 2u);
+}
+
+// ================== FIGURE FILE ==================
+TEST(FigureFileTest, WriteAndMapRoundTrip) {
+    Array<std::shared_ptr<Figure<int>>> arr;
+    arr.add(std::make_shared<Trapezoid<int>>(
+        Point<int>(0,0), Point<int>(4,0), Point<int>(3,2), Point<int>(0,2)));
+    arr.add(std::make_shared<Pentagon<int>>(
+        std::array<Point<int>,5>{{{0,0}, {1,0}, {2,1}, {1,2}, {0,1}}}));
+    arr.add(std::make_shared<Rhombus<int>>(
+        Point<int>(-4,-4), Point<int>(-3,-3), Point<int>(-2,-4), Point<int>(-3,-5)));
+
+    const std::string path = ::testing::TempDir() + "figures.bin";
+    writeFigureFile(path, arr);
+
+    {
+        MappedFigureFile<int> file(path);
+        ASSERT_EQ(file.getSize(), 3u);
+        for (size_t i = 0; i < file.getSize(); ++i) {
+            auto f = file[i];
+            EXPECT_STREQ(f.typeName(), arr[i]->typeName());
+            EXPECT_EQ(double(f), double(*arr[i]));
+            EXPECT_EQ(f.center(), arr[i]->center());
+            EXPECT_TRUE(f.materialize().visit([&](const auto& fig) { return fig.equals(*arr[i]); }));
+        }
+        EXPECT_EQ(file[2].center(), Point<int>(-3, -4));
+        EXPECT_TRUE(file[1].materialize().holds<Pentagon<int>>());
+        EXPECT_THROW(file[3], std::out_of_range);
+
+        EXPECT_THROW(MappedFigureFile<double>{path}, std::runtime_error);
+    }
+
+    {
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(0);
+        f.write("XXXX", 4);
+    }
+    EXPECT_THROW(MappedFigureFile<int>{path}, std::runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST(FigureFileTest, RejectsOffsetsThatWrap) {
+    Array<Rhombus<int>> arr;
+    arr.add(Rhombus<int>(Point<int>(0,1), Point<int>(1,0), Point<int>(2,1), Point<int>(1,2)));
+
+    const std::string path = ::testing::TempDir() + "wrapping.bin";
+    auto patch = [&](std::streamoff at, uint64_t value) {
+        writeFigureFile(path, arr);
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(at);
+        f.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+
+    patch(offsetof(FigureFileHeader, tableOffset), ~uint64_t{0} - 15);
+    EXPECT_THROW(MappedFigureFile<int>{path}, std::runtime_error);
+
+    // offset + vertexCount * sizeof(Point<int>) wraps around to 24
+    patch(sizeof(FigureFileHeader) + offsetof(FigureFileEntry, offset), ~uint64_t{0} - 7);
+    EXPECT_THROW(MappedFigureFile<int>{path}, std::runtime_error);
+
+    writeFigureFile(path, arr);
+    EXPECT_EQ(MappedFigureFile<int>(path).getSize(), 1u);
+    std::remove(path.c_str());
+}
+
+// ================== FIGURE STREAM ==================
+TEST(FigureStreamTest, ChunksInOrderWithBoundedBuffers) {
+    std::stringstream text;
+    for (int i = 0; i < 100; ++i) {
+        if (i % 10 == 7)
+            text << "Bogus 1 2\n";
+        else
+            text << "Rhombus 0 0 " << i << " 1 2 0 1 -1\n";
+    }
+
+    FigureStream<int> stream(text, 8);
+    size_t expectedIndex = 0;
+    size_t chunks = 0;
+    std::vector<size_t> errorLines;
+    AggregatePartial totals;
+
+    size_t total = stream.run([&](const FigureChunk<int>& chunk) {
+        EXPECT_EQ(chunk.firstIndex, expectedIndex);
+        EXPECT_LE(chunk.figures.getSize() + chunk.errors.size(), 8u);
+        EXPECT_LE(chunk.figures.getCapacity(), 8u);
+        expectedIndex += chunk.figures.getSize();
+        for (const auto& e : chunk.errors)
+            errorLines.push_back(e.line);
+        for (size_t i = 0; i < chunk.figures.getSize(); ++i)
+            totals.add(chunk.figures[i]);
+        ++chunks;
+    });
+
+    EXPECT_EQ(total, 90u);
+    EXPECT_EQ(chunks, 13u);
+    ASSERT_EQ(errorLines.size(), 10u);
+    EXPECT_EQ(errorLines.front(), 8u);
+    EXPECT_EQ(errorLines.back(), 98u);
+    EXPECT_EQ(totals.count, 90u);
+}
+
+TEST(FigureStreamTest, ConsumerExceptionStopsReader) {
+    std::stringstream text;
+    for (int i = 0; i < 1000; ++i)
+        text << "Rhombus 0 0 1 1 2 0 1 -1\n";
+
+    FigureStream<int> stream(text, 4);
+    size_t seen = 0;
+    EXPECT_THROW(stream.run([&](const FigureChunk<int>&) {
+        if (++seen == 3)
+            throw std::runtime_error("stop");
+    }), std::runtime_error);
+    EXPECT_EQ(seen, 3u);
+}
+
+// ================== REPORT WRITER ==================
+TEST(ReportWriterTest, TextMatchesIostreamPath) {
+    Array<std::shared_ptr<Figure<double>>> arr;
+    arr.add(std::make_shared<Trapezoid<double>>(
+        Point<double>(0,0), Point<double>(4,0), Point<double>(3,2), Point<double>(0,2)));
+    arr.add(std::make_shared<Rhombus<double>>(
+        Point<double>(0,0), Point<double>(1.25,1), Point<double>(2,0), Point<double>(1,-1)));
+
+    std::stringstream legacy;
+    auto* old = std::cout.rdbuf(legacy.rdbuf());
+    arr.printAll();
+    arr.printCenters();
+    arr.printTotalArea();
+    std::cout.rdbuf(old);
+
+    std::stringstream buffered;
+    {
+        ReportWriter out(buffered, ReportFormat::Text, 4, 16);
+        printAll(arr, out);
+        printCenters(arr, out);
+        printTotalArea(arr, out);
+    }
+
+    EXPECT_EQ(buffered.str(), legacy.str());
+}
+
+TEST(ReportWriterTest, CsvAndJsonLines) {
+    Array<Rhombus<int>> arr;
+    arr.emplace(Point<int>(0,0), Point<int>(1,1), Point<int>(2,0), Point<int>(1,-1));
+
+    std::stringstream csv;
+    {
+        ReportWriter out(csv, ReportFormat::Csv, 2);
+        out.write(0, arr[0]);
+    }
+    EXPECT_EQ(csv.str(),
+              "index,type,area,center_x,center_y,vertices\n"
+              "0,Rhombus,2.00,1,0,\"0 0 1 1 2 0 1 -1\"\n");
+
+    std::stringstream json;
+    {
+        ReportWriter out(json, ReportFormat::JsonLines, 1);
+        out.write(7, arr[0]);
+        out.totals(aggregate(arr));
+    }
+    EXPECT_EQ(json.str(),
+              "{\"index\":7,\"type\":\"Rhombus\",\"area\":2.0,\"center\":[1,0],"
+              "\"vertices\":[[0,0],[1,1],[2,0],[1,-1]]}\n"
+              "{\"figures\":1,\"total_area\":2.0,\"centroid\":[1.0,0.0]}\n");
+}
+
+// ================== FIGURE ARENA ==================
+TEST(FigureArenaTest, PacksFiguresAndCountsAllocations) {
+    FigureArena arena(16);
+    Array<std::shared_ptr<Figure<int>>> arr;
+    arr.reserve(3000);
+
+    size_t before = g_allocations.load();
+    for (int i = 0; i < 1000; ++i) {
+        arr.add(arena.share<Trapezoid<int>>(
+            Point<int>(0,0), Point<int>(4,0), Point<int>(3,2), Point<int>(0,2)));
+        arr.add(arena.share<Rhombus<int>>(
+            Point<int>(0,0), Point<int>(1,1), Point<int>(2,0), Point<int>(1,-1)));
+        arr.add(arena.share<Pentagon<int>>(
+            std::array<Point<int>,5>{{{0,0}, {1,0}, {2,1}, {1,2}, {0,1}}}));
+    }
+    size_t heapCalls = g_allocations.load() - before;
+
+    ArenaStats st = arena.stats();
+    EXPECT_EQ(st.objects, 3000u);
+    EXPECT_EQ(st.bytesUsed, 1000 * (sizeof(Trapezoid<int>) + sizeof(Rhombus<int>) + sizeof(Pentagon<int>)));
+    EXPECT_GE(st.bytesReserved, st.bytesUsed);
+    // 16 + 32 + ... + 512 >= 1000 per type: 6 slabs each.
+    EXPECT_EQ(st.allocations, 18u);
+    EXPECT_LT(heapCalls, 50u);
+
+    // Same-type figures are adjacent in memory.
+    auto* t0 = arr[0].get();
+    auto* t1 = arr[3].get();
+    EXPECT_EQ(reinterpret_cast<const char*>(t1) - reinterpret_cast<const char*>(t0),
+              static_cast<std::ptrdiff_t>(sizeof(Trapezoid<int>)));
+
+    EXPECT_NEAR(aggregate(arr).totalArea, 1000 * (7.0 + 2.0 + 2.5), 1e-6);
+
+    // Handles keep the slabs alive after the arena lets go.
+    arena.release();
+    EXPECT_EQ(arena.stats().objects, 0u);
+    EXPECT_NEAR(double(*arr[2999]), 2.5, 1e-9);
+    arr.clear();
+}
+
+TEST(FigureArenaTest, RawPointersInArray) {
+    FigureArena arena;
+    Array<Figure<double>*> arr;
+    arr.add(arena.create<Trapezoid<double>>(
+        Point<double>(0,0), Point<double>(4,0), Point<double>(3,2), Point<double>(0,2)));
+    arr.add(arena.create<Rhombus<double>>(
+        Point<double>(0,0), Point<double>(1,1), Point<double>(2,0), Point<double>(1,-1)));
+
+    EXPECT_NEAR(aggregate(arr).totalArea, 9.0, 1e-9);
+    EXPECT_STREQ(arr[1]->typeName(), "Rhombus");
+}
+
+TEST(FigureArenaTest, MovedFromArenaIsEmptyAndUsable) {
+    FigureArena arena(4);
+    auto* t = arena.create<Trapezoid<int>>(Point<int>(0,0), Point<int>(4,0), Point<int>(3,2), Point<int>(0,2));
+
+    FigureArena other(std::move(arena));
+    EXPECT_EQ(other.stats().objects, 1u);
+    EXPECT_EQ(arena.stats().objects, 0u);
+    EXPECT_EQ(arena.stats().bytesReserved, 0u);
+
+    auto r = arena.share<Rhombus<int>>(Point<int>(0,0), Point<int>(1,1), Point<int>(2,0), Point<int>(1,-1));
+    EXPECT_EQ(arena.stats().objects, 1u);
+    EXPECT_EQ(arena.stats().allocations, 1u);
+    EXPECT_EQ(double(*r), 2.0);
+    EXPECT_EQ(double(*t), 7.0);
+
+    arena = std::move(other);
+    EXPECT_EQ(arena.stats().objects, 1u);
+    EXPECT_EQ(other.stats().objects, 0u);
+    EXPECT_EQ(double(*r), 2.0);     // the handle keeps its slabs
+}
+
+// ================== CONCURRENT ARRAY ==================
+TEST(ConcurrentArrayTest, ConcurrentAppendAndSnapshots) {
+    constexpr int writers = 4;
+    constexpr int perWriter = 5000;
+
+    ConcurrentArray<Rhombus<int>> arr;
+    std::atomic<bool> done{false};
+    std::atomic<size_t> badReads{0};
+
+    std::thread reader([&] {
+        size_t last = 0;
+        while (!done.load()) {
+            auto snap = arr.snapshot();
+            if (snap.getSize() < last)
+                ++badReads;
+            last = snap.getSize();
+            for (size_t i = 0; i < snap.getSize(); i += 97)
+                if (double(snap[i]) != 2.0 * (snap[i].points()[2].x() / 2))
+                    ++badReads;
+        }
+    });
+
+    std::vector<std::thread> pool;
+    std::vector<std::vector<size_t>> indices(writers);
+    for (int w = 0; w < writers; ++w) {
+        pool.emplace_back([&, w] {
+            for (int i = 0; i < perWriter; ++i) {
+                int d = 2 * (w * perWriter + i + 1);
+                indices[w].push_back(arr.emplace(
+                    Point<int>(0,0), Point<int>(d/2,1), Point<int>(d,0), Point<int>(d/2,-1)));
+            }
+        });
+    }
+    for (auto& t : pool)
+        t.join();
+    done = true;
+    reader.join();
+
+    EXPECT_EQ(badReads.load(), 0u);
+    ASSERT_EQ(arr.getSize(), size_t(writers * perWriter));
+
+    // Indices are stable: each writer's elements are where add() said.
+    for (int w = 0; w < writers; ++w)
+        for (int i = 0; i < perWriter; i += 101) {
+            int d = 2 * (w * perWriter + i + 1);
+            EXPECT_EQ(arr[indices[w][i]].points()[2], Point<int>(d, 0));
+        }
+    EXPECT_THROW(arr[writers * perWriter], std::out_of_range);
+}
+
+// ================== SPATIAL GRID ==================
+namespace {
+
+// Squares of side 1..3 scattered over [0, 100)^2, as rhombi and trapezoids.
+Array<FigureVariant<double>> makeScatter(size_t n) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> pos(0.0, 100.0), side(1.0, 3.0);
+    Array<FigureVariant<double>> arr;
+    for (size_t i = 0; i < n; ++i) {
+        double x = pos(rng), y = pos(rng), s = side(rng);
+        if (i % 2)
+            arr.add(Rhombus<double>(Point<double>(x, y + s/2), Point<double>(x + s/2, y),
+                                    Point<double>(x + s, y + s/2), Point<double>(x + s/2, y + s)));
+        else
+            arr.add(Trapezoid<double>(Point<double>(x, y), Point<double>(x + s, y),
+                                      Point<double>(x + s, y + s), Point<double>(x, y + s)));
+    }
+    return arr;
+}
+
+std::vector<size_t> bruteWindow(const Array<FigureVariant<double>>& arr, const BoundingBox<double>& w) {
+    std::vector<size_t> ids;
+    for (size_t i = 0; i < arr.getSize(); ++i) {
+        auto b = arr[i].boundingBox();
+        if (b.min.x() <= w.max.x() && w.min.x() <= b.max.x() &&
+            b.min.y() <= w.max.y() && w.min.y() <= b.max.y())
+            ids.push_back(i);
+    }
+    return ids;
+}
+
+std::vector<size_t> sorted(std::vector<size_t> ids) {
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+}
+
+TEST(PolygonTest, ContainsPoint) {
+    Trapezoid<int> t(Point<int>(0,0), Point<int>(4,0), Point<int>(3,2), Point<int>(1,2));
+    EXPECT_TRUE(polygonContains(t.points(), Point<int>(2,1)));
+    EXPECT_TRUE(polygonContains(t.points(), Point<int>(0,0)));   // vertex
+    EXPECT_TRUE(polygonContains(t.points(), Point<int>(2,2)));   // edge
+    EXPECT_FALSE(polygonContains(t.points(), Point<int>(0,2)));
+    EXPECT_FALSE(polygonContains(t.points(), Point<int>(5,1)));
+}
+
+TEST(SpatialGridTest, WindowQueryMatchesBruteForce) {
+    auto arr = makeScatter(2000);
+    auto grid = SpatialGrid<double>::build(arr);
+    EXPECT_EQ(grid.getSize(), arr.getSize());
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> pos(-10.0, 110.0), len(0.0, 30.0);
+    for (int q = 0; q < 100; ++q) {
+        double x = pos(rng), y = pos(rng);
+        BoundingBox<double> w{{x, y}, {x + len(rng), y + len(rng)}};
+
+        std::vector<size_t> found;
+        grid.query(w, found);
+        EXPECT_EQ(sorted(found), bruteWindow(arr, w));
+    }
+}
+
+TEST(SpatialGridTest, PointQueryIsExact) {
+    auto arr = makeScatter(2000);
+    auto grid = SpatialGrid<double>::build(arr);
+
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> pos(0.0, 100.0);
+    for (int q = 0; q < 200; ++q) {
+        Point<double> p(pos(rng), pos(rng));
+
+        std::vector<size_t> found, expected;
+        grid.containing(arr, p, found);
+        for (size_t i = 0; i < arr.getSize(); ++i)
+            if (polygonContains(arr[i].points(), p))
+                expected.push_back(i);
+        EXPECT_EQ(sorted(found), expected);
+    }
+}
+
+TEST(SpatialGridTest, WideExtentSpreadsOverCells) {
+    // 20000 unit squares 10 apart along x: density alone asks for ~45000
+    // columns, more than the grid allows per axis.
+    Array<Trapezoid<double>> arr;
+    for (int i = 0; i < 20000; ++i) {
+        double x = 10.0 * i;
+        arr.add(Trapezoid<double>(Point<double>(x, 0), Point<double>(x + 1, 0),
+                                  Point<double>(x + 1, 1), Point<double>(x, 1)));
+    }
+
+    auto grid = SpatialGrid<double>::build(arr);
+    EXPECT_GE(grid.getCellSize() * 4096, 10.0 * 19999 + 1);
+
+    size_t worst = 0;
+    for (size_t i = 0; i < arr.getSize(); ++i)
+        worst = std::max(worst, grid.cellLoad(arr[i].center()));
+    EXPECT_LE(worst, 7u);
+
+    std::vector<size_t> hits;
+    grid.containing(arr, Point<double>(10.0 * 19999 + 0.5, 0.5), hits);
+    EXPECT_EQ(hits, std::vector<size_t>{19999});
+}
+
+TEST(SpatialGridTest, StaysInSyncWithArray) {
+    auto arr = makeScatter(500);
+    auto grid = SpatialGrid<double>::build(arr);
+
+    // A figure larger than the whole extent goes to the oversized list.
+    grid.add(arr, Trapezoid<double>(Point<double>(-50,-50), Point<double>(150,-50),
+                                    Point<double>(150,150), Point<double>(-50,150)));
+    for (size_t i = 0; i < 200; ++i)
+        grid.swapRemove(arr, (i * 37) % arr.getSize());
+    grid.add(arr, Rhombus<double>(Point<double>(200,201), Point<double>(201,200),
+                                  Point<double>(202,201), Point<double>(201,202)));
+
+    EXPECT_EQ(grid.getSize(), arr.getSize());
+    BoundingBox<double> everything{{-1000, -1000}, {1000, 1000}};
+    BoundingBox<double> corner{{0, 0}, {20, 20}};
+    std::vector<size_t> all, some;
+    grid.query(everything, all);
+    grid.query(corner, some);
+    EXPECT_EQ(sorted(all), bruteWindow(arr, everything));
+    EXPECT_EQ(sorted(some), bruteWindow(arr, corner));
+
+    EXPECT_THROW(grid.erase(arr.getSize()), std::out_of_range);
+    EXPECT_THROW(grid.insert(0, arr[0].boundingBox()), std::invalid_argument);
+}
+
+// ================== KD TREE ==================
+namespace {
+
+std::vector<KdTree<double>::Neighbor> bruteNearest(const std::vector<Point<double>>& pts,
+                                                   const Point<double>& probe, size_t k, double radius) {
+    std::vector<KdTree<double>::Neighbor> all;
+    for (size_t i = 0; i < pts.size(); ++i) {
+        double d2 = pts[i].squaredDistanceTo(probe);
+        if (d2 <= radius * radius)
+            all.push_back({i, d2});
+    }
+    std::sort(all.begin(), all.end(), [](const auto& a, const auto& b) {
+        return a.distance < b.distance || (a.distance == b.distance && a.id < b.id);
+    });
+    if (all.size() > k)
+        all.resize(k);
+    for (auto& nb : all)
+        nb.distance = std::sqrt(nb.distance);
+    return all;
+}
+
+}
+
+TEST(KdTreeTest, NearestMatchesBruteForce) {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> coord(-50.0, 50.0);
+    std::uniform_int_distribution<int> grid(-5, 5);
+
+    // Half random, half on a coarse lattice to get many ties.
+    std::vector<Point<double>> pts;
+    for (int i = 0; i < 3000; ++i)
+        pts.emplace_back(i % 2 ? coord(rng) : grid(rng), i % 2 ? coord(rng) : grid(rng));
+    KdTree<double> tree(pts);
+    ASSERT_EQ(tree.getSize(), pts.size());
+
+    std::vector<Point<double>> probes;
+    for (int i = 0; i < 300; ++i)
+        probes.emplace_back(coord(rng), coord(rng));
+
+    const double inf = std::numeric_limits<double>::infinity();
+    auto batch = tree.nearest(std::span<const Point<double>>(probes), 10, 4);
+    ASSERT_EQ(batch.size(), probes.size() * 10);
+
+    for (size_t p = 0; p < probes.size(); ++p) {
+        auto expected = bruteNearest(pts, probes[p], 10, inf);
+        EXPECT_EQ(tree.nearest(probes[p], 10), expected);
+        EXPECT_TRUE(std::equal(expected.begin(), expected.end(), batch.begin() + p * 10));
+    }
+
+    // k larger than the tree returns everything.
+    EXPECT_EQ(tree.nearest(probes[0], 5000).size(), pts.size());
+    EXPECT_TRUE(KdTree<double>().nearest(probes[0], 3).empty());
+}
+
+TEST(KdTreeTest, WithinRadius) {
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> coord(-50.0, 50.0);
+    std::vector<Point<double>> pts, probes;
+    for (int i = 0; i < 2000; ++i)
+        pts.emplace_back(coord(rng), coord(rng));
+    for (int i = 0; i < 200; ++i)
+        probes.emplace_back(coord(rng), coord(rng));
+
+    KdTree<double> tree(pts);
+    auto batch = tree.within(std::span<const Point<double>>(probes), 6.0, 3);
+    ASSERT_EQ(batch.size(), probes.size());
+    for (size_t p = 0; p < probes.size(); ++p) {
+        auto expected = bruteNearest(pts, probes[p], pts.size(), 6.0);
+        EXPECT_EQ(batch[p], expected);
+        EXPECT_EQ(tree.within(probes[p], 6.0), expected);
+    }
+}
+
+TEST(KdTreeTest, BuildFromFigureCenters) {
+    Array<std::shared_ptr<Figure<int>>> arr;
+    arr.add(std::make_shared<Rhombus<int>>(Point<int>(0,1), Point<int>(1,0), Point<int>(2,1), Point<int>(1,2)));
+    arr.add(std::make_shared<Trapezoid<int>>(Point<int>(10,10), Point<int>(14,10), Point<int>(13,12), Point<int>(11,12)));
+    arr.add(std::make_shared<Rhombus<int>>(Point<int>(4,5), Point<int>(5,4), Point<int>(6,5), Point<int>(5,6)));
+
+    auto tree = KdTree<int>::build(arr);
+    auto res = tree.nearest(Point<int>(6,6), 2);
+    ASSERT_EQ(res.size(), 2u);
+    EXPECT_EQ(res[0].id, 2u);
+    EXPECT_DOUBLE_EQ(res[0].distance, std::sqrt(2.0));
+    EXPECT_EQ(res[1].id, 0u);
+}
+
+// ================== CONTAINMENT ==================
+TEST(ContainmentTest, FiguresContainPoints) {
+    std::shared_ptr<Figure<int>> t = std::make_shared<Trapezoid<int>>(
+        Point<int>(0,0), Point<int>(4,0), Point<int>(3,2), Point<int>(1,2));
+    std::shared_ptr<Figure<int>> r = std::make_shared<Rhombus<int>>(
+        Point<int>(0,1), Point<int>(1,0), Point<int>(2,1), Point<int>(1,2));
+    Pentagon<int> p({Point<int>(0,0), Point<int>(4,0), Point<int>(5,3), Point<int>(2,5), Point<int>(-1,3)});
+
+    EXPECT_TRUE(t->contains(Point<int>(2,1)));
+    EXPECT_TRUE(t->contains(Point<int>(4,0)));
+    EXPECT_FALSE(t->contains(Point<int>(4,2)));
+    EXPECT_TRUE(r->contains(Point<int>(1,1)));
+    EXPECT_FALSE(r->contains(Point<int>(0,0)));
+    EXPECT_TRUE(p.contains(Point<int>(2,4)));
+    EXPECT_FALSE(p.contains(Point<int>(5,5)));
+
+    FigureVariant<int> v = p;
+    EXPECT_TRUE(v.contains(Point<int>(-1,3)));
+    EXPECT_FALSE(v.contains(Point<int>(-1,0)));
+}
+
+TEST(ContainmentTest, BatchMatchesScalar) {
+    Pentagon<double> p({Point<double>(0,0), Point<double>(8,0), Point<double>(10,6),
+                        Point<double>(4,10), Point<double>(-2,6)});
+
+    // Lattice points hit vertices and edges exactly; random ones do not.
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> coord(-4.0, 12.0);
+    std::vector<Point<double>> pts;
+    for (int y = -3; y <= 12; ++y)
+        for (int x = -3; x <= 12; ++x)
+            pts.emplace_back(x, y);
+    for (int i = 0; i < 20001; ++i)
+        pts.emplace_back(coord(rng), coord(rng));
+
+    auto flags = containsBatch(p, std::span<const Point<double>>(pts), 3);
+    ASSERT_EQ(flags.size(), pts.size());
+    size_t inside = 0;
+    for (size_t i = 0; i < pts.size(); ++i) {
+        EXPECT_EQ(flags[i] != 0, p.contains(pts[i])) << pts[i];
+        inside += flags[i];
+    }
+    EXPECT_GT(inside, 0u);
+
+    std::vector<Point<int>> ipts{Point<int>(0,0), Point<int>(5,5), Point<int>(20,0)};
+    Trapezoid<int> t(Point<int>(0,0), Point<int>(10,0), Point<int>(8,6), Point<int>(2,6));
+    EXPECT_EQ(containsBatch(t, std::span<const Point<int>>(ipts)), (std::vector<std::uint8_t>{1, 1, 0}));
+}
+
+TEST(ContainmentTest, OnePointManyFigures) {
+    FigureStore<double, 4> store;
+    std::vector<Rhombus<double>> figs;
+    for (int i = 0; i < 37; ++i) {
+        double c = i % 7, s = 1 + i % 3;
+        figs.emplace_back(Point<double>(c - s, c), Point<double>(c, c - s),
+                          Point<double>(c + s, c), Point<double>(c, c + s));
+        store.add(figs.back());
+    }
+
+    for (int y = -2; y <= 9; ++y)
+        for (int x = -2; x <= 9; ++x) {
+            Point<double> p(x * 0.5 + 1, y);
+            std::vector<size_t> found, expected;
+            store.containing(p, found);
+            for (size_t i = 0; i < figs.size(); ++i)
+                if (figs[i].contains(p))
+                    expected.push_back(i);
+            EXPECT_EQ(found, expected) << p;
+        }
+}
+
+TEST(ContainmentTest, ClassifyPoints) {
+    auto arr = makeScatter(1500);
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<double> coord(-5.0, 105.0);
+    std::vector<Point<double>> pts;
+    for (int i = 0; i < 5000; ++i)
+        pts.emplace_back(coord(rng), coord(rng));
+
+    auto owner = classifyPoints(arr, std::span<const Point<double>>(pts), 4);
+    ASSERT_EQ(owner.size(), pts.size());
+    for (size_t i = 0; i < pts.size(); ++i) {
+        size_t expected = noFigure;
+        for (size_t f = 0; f < arr.getSize() && expected == noFigure; ++f)
+            if (arr[f].contains(pts[i]))
+                expected = f;
+        EXPECT_EQ(owner[i], expected);
+    }
+}
+
+// ================== OVERLAP ==================
+TEST(OverlapTest, ExactPolygonTests) {
+    using P = Point<int>;
+    EXPECT_TRUE(segmentsIntersect(P(0,0), P(4,4), P(0,4), P(4,0)));
+    EXPECT_TRUE(segmentsIntersect(P(0,0), P(4,0), P(4,0), P(6,3)));    // shared endpoint
+    EXPECT_TRUE(segmentsIntersect(P(0,0), P(4,0), P(2,0), P(6,0)));    // collinear overlap
+    EXPECT_FALSE(segmentsIntersect(P(0,0), P(4,0), P(5,0), P(6,0)));
+    EXPECT_FALSE(segmentsIntersect(P(0,0), P(4,4), P(1,0), P(5,4)));
+
+    Trapezoid<int> big(P(0,0), P(10,0), P(8,6), P(2,6));
+    Rhombus<int> inner(P(4,3), P(5,2), P(6,3), P(5,4));
+    Rhombus<int> touching(P(10,0), P(11,-1), P(12,0), P(11,1));
+    Rhombus<int> apart(P(20,0), P(21,-1), P(22,0), P(21,1));
+
+    EXPECT_TRUE(polygonsIntersect(big.points(), inner.points()));
+    EXPECT_TRUE(polygonsIntersect(inner.points(), big.points()));
+    EXPECT_TRUE(polygonsIntersect(big.points(), touching.points()));
+    EXPECT_FALSE(polygonsIntersect(big.points(), apart.points()));
+}
+
+TEST(OverlapTest, PairsMatchBruteForce) {
+    auto arr = makeScatter(1500);
+
+    std::vector<FigurePair> expected;
+    for (size_t i = 0; i < arr.getSize(); ++i)
+        for (size_t j = i + 1; j < arr.getSize(); ++j)
+            if (polygonsIntersect(arr[i].points(), arr[j].points()))
+                expected.emplace_back(i, j);
+    ASSERT_FALSE(expected.empty());
+
+    EXPECT_EQ(overlappingPairs(arr, 1), expected);
+    EXPECT_EQ(overlappingPairs(arr, 4), expected);
+}
+
+TEST(OverlapTest, PolymorphicArray) {
+    Array<std::shared_ptr<Figure<int>>> arr;
+    arr.add(std::make_shared<Trapezoid<int>>(Point<int>(0,0), Point<int>(10,0), Point<int>(8,6), Point<int>(2,6)));
+    arr.add(std::make_shared<Rhombus<int>>(Point<int>(20,0), Point<int>(21,-1), Point<int>(22,0), Point<int>(21,1)));
+    arr.add(std::make_shared<Rhombus<int>>(Point<int>(4,3), Point<int>(5,2), Point<int>(6,3), Point<int>(5,4)));
+    arr.add(std::make_shared<Pentagon<int>>(std::array<Point<int>, 5>{
+        Point<int>(8,5), Point<int>(12,5), Point<int>(13,8), Point<int>(10,10), Point<int>(7,8)}));
+
+    EXPECT_EQ(overlappingPairs(arr), (std::vector<FigurePair>{{0, 2}, {0, 3}}));
+
+    Array<std::shared_ptr<Figure<int>>> single;
+    single.add(arr[0]);
+    EXPECT_TRUE(overlappingPairs(single).empty());
+}
+
+// ================== HASHING ==================
+TEST(HashTest, StableAndConsistentWithEquality) {
+    Trapezoid<double> a(Point<double>(0,0), Point<double>(4,0), Point<double>(3,2), Point<double>(1,2));
+    Trapezoid<double> b(Point<double>(-0.0,0), Point<double>(4,0), Point<double>(3,2), Point<double>(1,2));
+    Rhombus<double> r(Point<double>(0,0), Point<double>(4,0), Point<double>(3,2), Point<double>(1,2));
+
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a.hash(), b.hash());
+    EXPECT_NE(a.hash(), r.hash());     // same vertices, different type tag
+    EXPECT_EQ(FigureVariant<double>(a).hash(), a.hash());
+
+    // Pinned value: hashes must not change between runs or builds.
+    Rhombus<int> ri(Point<int>(0,1), Point<int>(1,0), Point<int>(2,1), Point<int>(1,2));
+    EXPECT_EQ(hashString("Rhombus"), 0xc13e1f61795f65cfULL);
+    EXPECT_EQ(ri.hash(), 0x58df293e5725e052ULL);
+}
+
+namespace {
+
+// n figures with only `distinct` different ones, in a shuffled order.
+Array<std::shared_ptr<Figure<int>>> makeDuplicates(size_t n, int distinct) {
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> pick(0, distinct - 1);
+    Array<std::shared_ptr<Figure<int>>> arr;
+    for (size_t i = 0; i < n; ++i) {
+        int k = pick(rng);
+        if (k % 2)
+            arr.add(std::make_shared<Rhombus<int>>(Point<int>(k,1), Point<int>(k+1,0), Point<int>(k+2,1), Point<int>(k+1,2)));
+        else
+            arr.add(std::make_shared<Trapezoid<int>>(Point<int>(k,1), Point<int>(k+1,0), Point<int>(k+2,1), Point<int>(k+1,2)));
+    }
+    return arr;
+}
+
+}
+
+TEST(HashTest, DedupeKeepsFirstOccurrences) {
+    for (size_t n : {size_t(500), size_t(70000)}) {
+        auto arr = makeDuplicates(n, 300);
+
+        std::vector<std::shared_ptr<Figure<int>>> expected;
+        for (size_t i = 0; i < arr.getSize(); ++i) {
+            bool seen = false;
+            for (const auto& e : expected)
+                seen = seen || *e == *arr[i];
+            if (!seen)
+                expected.push_back(arr[i]);
+        }
+
+        EXPECT_EQ(uniqueCount(arr, 3), expected.size());
+        EXPECT_EQ(dedupe(arr, 3), n - expected.size());
+        ASSERT_EQ(arr.getSize(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+            EXPECT_EQ(arr[i], expected[i]);     // same objects, same order
+        EXPECT_EQ(dedupe(arr), 0u);
+    }
+}
+
+TEST(HashTest, HashJoin) {
+    auto left = makeDuplicates(400, 50);
+    Array<Rhombus<int>> right;
+    for (int k = 40; k < 60; ++k)
+        right.add(Rhombus<int>(Point<int>(k,1), Point<int>(k+1,0), Point<int>(k+2,1), Point<int>(k+1,2)));
+
+    std::vector<std::pair<size_t, size_t>> expected;
+    for (size_t i = 0; i < left.getSize(); ++i)
+        for (size_t j = 0; j < right.getSize(); ++j)
+            if (*left[i] == right[j])
+                expected.emplace_back(i, j);
+    ASSERT_FALSE(expected.empty());
+
+    EXPECT_EQ(hashJoin(left, right, 2), expected);
+    EXPECT_TRUE(hashJoin(Array<Rhombus<int>>(), right).empty());
+}
+
+// ================== RANKING ==================
+namespace {
+
+// Squares with side 1 + i % 37 (so many equal areas), as a polymorphic array.
+Array<std::shared_ptr<Figure<int>>> makeSquares(size_t n) {
+    Array<std::shared_ptr<Figure<int>>> arr;
+    for (size_t i = 0; i < n; ++i) {
+        int s = 1 + static_cast<int>((i * 7919) % 37);
+        int x = static_cast<int>(i);
+        arr.add(std::make_shared<Trapezoid<int>>(Point<int>(x,0), Point<int>(x+s,0), Point<int>(x+s,s), Point<int>(x,s)));
+    }
+    return arr;
+}
+
+}
+
+TEST(RankingTest, SortByAreaIsStable) {
+    for (size_t n : {size_t(300), size_t(100000)}) {
+        auto arr = makeSquares(n);
+        std::vector<std::pair<double, int>> expected;
+        for (size_t i = 0; i < n; ++i)
+            expected.emplace_back(double(*arr[i]), arr[i]->points()[0].x());
+        std::stable_sort(expected.begin(), expected.end(),
+                         [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        sortBy(arr, {}, 4);
+        ASSERT_EQ(arr.getSize(), n);
+        for (size_t i = 0; i < n; ++i) {
+            EXPECT_EQ(double(*arr[i]), expected[i].first);
+            EXPECT_EQ(arr[i]->points()[0].x(), expected[i].second);
+        }
+    }
+
+    // Custom key: descending center x.
+    auto arr = makeSquares(50);
+    sortBy(arr, [](const Figure<int>& f) { return -f.center().x(); });
+    for (size_t i = 1; i < arr.getSize(); ++i)
+        EXPECT_GE(arr[i - 1]->center().x(), arr[i]->center().x());
+}
+
+TEST(RankingTest, TopK) {
+    auto arr = makeSquares(20000);
+    std::vector<size_t> all(arr.getSize());
+    for (size_t i = 0; i < all.size(); ++i)
+        all[i] = i;
+    std::stable_sort(all.begin(), all.end(),
+                     [&](size_t a, size_t b) { return double(*arr[a]) > double(*arr[b]); });
+
+    for (size_t k : {size_t(0), size_t(1), size_t(10), size_t(5000)}) {
+        auto top = topK(arr, k, {}, 3);
+        EXPECT_EQ(top, std::vector<size_t>(all.begin(), all.begin() + k));
+    }
+    EXPECT_EQ(topK(arr, 100000).size(), arr.getSize());
+}
+
+TEST(RankingTest, PercentilesAndHistogram) {
+    Array<Rhombus<double>> arr;
+    for (int i = 1; i <= 101; ++i) {
+        double d = std::sqrt(2.0 * i);     // area = d^2 / 2 = i
+        arr.add(Rhombus<double>(Point<double>(0, d/2), Point<double>(d/2, 0), Point<double>(d, d/2), Point<double>(d/2, d)));
+    }
+
+    auto p = percentiles(arr, {0, 25, 50, 99.5, 100}, {}, 2);
+    EXPECT_NEAR(p[0], 1.0, 1e-9);
+    EXPECT_NEAR(p[1], 26.0, 1e-9);
+    EXPECT_NEAR(p[2], 51.0, 1e-9);
+    EXPECT_NEAR(p[3], 100.5, 1e-9);
+    EXPECT_NEAR(p[4], 101.0, 1e-9);
+    EXPECT_NEAR(percentile(arr, 50), 51.0, 1e-9);
+    EXPECT_THROW(percentile(arr, 101), std::invalid_argument);
+    EXPECT_THROW(percentile(Array<Rhombus<double>>(), 50), std::out_of_range);
+
+    auto h = histogram(arr, 4, 0.5, 100.5);
+    EXPECT_EQ(h, (std::vector<size_t>{25, 25, 25, 25}));
+    EXPECT_EQ(histogram(arr, 1, 0.5, 200.0).front(), 101u);
+    EXPECT_THROW(histogram(arr, 0, 0.0, 1.0), std::invalid_argument);
+}
+
+// ================== ARRAY ITERATORS ==================
+static_assert(std::ranges::contiguous_range<Array<Trapezoid<int>>>);
+static_assert(std::ranges::contiguous_range<const Array<std::shared_ptr<Figure<double>>>>);
+
+TEST(ArrayIteratorTest, RangeForAndAlgorithms) {
+    auto arr = makeSquares(1000);
+
+    double total = 0.0;
+    for (const auto& f : arr)
+        total += double(*f);
+    EXPECT_DOUBLE_EQ(total, aggregate(arr).totalArea);
+
+    EXPECT_EQ(arr.end() - arr.begin(), static_cast<std::ptrdiff_t>(arr.getSize()));
+    EXPECT_EQ(arr.data(), &arr[0]);
+    EXPECT_EQ(&arr.uncheckedAt(999), &arr[999]);
+
+    std::ranges::sort(arr, {}, [](const auto& f) { return double(*f); });
+    EXPECT_TRUE(std::ranges::is_sorted(arr, {}, [](const auto& f) { return double(*f); }));
+
+    auto large = [](const auto& f) { return double(*f) > 1000.0; };
+    auto view = arr | std::views::filter(large);
+    EXPECT_EQ(std::ranges::distance(view), std::ranges::count_if(arr, large));
+    EXPECT_GT(std::ranges::count_if(arr, large), 0);
+
+    const auto& cref = arr;
+    EXPECT_EQ(std::distance(cref.cbegin(), cref.cend()), 1000);
+}
+
+TEST(ArrayIteratorTest, TransformReduce) {
+    Array<Rhombus<double>> arr;
+    for (int i = 1; i <= 5000; ++i) {
+        double d = i % 50 + 1.0;
+        arr.add(Rhombus<double>(Point<double>(0, d/2), Point<double>(d/2, 0), Point<double>(d, d/2), Point<double>(d/2, d)));
+    }
+
+    // double(r) may fill the figure's cache, so par, not par_unseq.
+    auto area = [](const Rhombus<double>& r) { return double(r); };
+#ifdef LAB4_HAS_TBB
+    double total = std::transform_reduce(std::execution::par, arr.begin(), arr.end(),
+                                         0.0, std::plus<>{}, area);
+#else
+    double total = std::transform_reduce(arr.begin(), arr.end(), 0.0, std::plus<>{}, area);
+#endif
+    EXPECT_NEAR(total, aggregate(arr).totalArea, 1e-6);
+}
+
+// ================== SMALL ARRAY ==================
+TEST(SmallArrayTest, InlineStorageAvoidsHeap) {
+    Rhombus<int> r(Point<int>(0,1), Point<int>(1,0), Point<int>(2,1), Point<int>(1,2));
+
+    size_t before = g_allocations.load();
+    {
+        Array<Rhombus<int>, 8> arr;
+        for (int i = 0; i < 8; ++i)
+            arr.add(r);
+        EXPECT_TRUE(arr.isInline());
+        EXPECT_EQ(arr.getCapacity(), 8u);
+
+        ArrayMemory m = arr.memoryUsage();
+        EXPECT_EQ(m.bytesUsed, 8 * sizeof(Rhombus<int>));
+        EXPECT_EQ(m.bytesReserved, 8 * sizeof(Rhombus<int>));
+        EXPECT_EQ(m.heapBytes, 0u);
+        EXPECT_EQ(g_allocations.load(), before);
+
+        arr.add(r);     // spills to the heap once
+        EXPECT_FALSE(arr.isInline());
+        EXPECT_EQ(g_allocations.load() - before, 1u);
+        EXPECT_EQ(arr.getCapacity(), 16u);
+        EXPECT_EQ(arr.memoryUsage().heapBytes, 16 * sizeof(Rhombus<int>));
+        EXPECT_EQ(double(arr[8]), 2.0);
+    }
+}
+
+TEST(SmallArrayTest, MoveAndShrink) {
+    auto make = [](int i) {
+        return std::make_shared<Trapezoid<int>>(Point<int>(i,0), Point<int>(i+4,0), Point<int>(i+3,2), Point<int>(i+1,2));
+    };
+
+    Array<std::shared_ptr<Figure<int>>, 4> small;
+    for (int i = 0; i < 3; ++i)
+        small.add(make(i));
+
+    Array<std::shared_ptr<Figure<int>>, 4> moved(std::move(small));
+    EXPECT_TRUE(moved.isInline());
+    EXPECT_EQ(moved.getSize(), 3u);
+    EXPECT_EQ(moved[2]->points()[0], Point<int>(2,0));
+    EXPECT_EQ(moved[2].use_count(), 1);
+    EXPECT_EQ(small.getSize(), 0u);
+    small.add(make(9));     // still usable
+    EXPECT_EQ(small.getSize(), 1u);
+
+    for (int i = 3; i < 20; ++i)
+        moved.add(make(i));
+    EXPECT_FALSE(moved.isInline());
+
+    const auto* heap = moved.data();
+    size_t before = g_allocations.load();
+    small = std::move(moved);            // heap buffer is stolen, not copied
+    EXPECT_EQ(small.data(), heap);
+    EXPECT_EQ(g_allocations.load(), before);
+    EXPECT_TRUE(moved.isInline());
+
+    small.removeRange(5, 20);
+    small.shrinkToFit();
+    EXPECT_EQ(small.getCapacity(), 5u);
+    EXPECT_FALSE(small.isInline());
+
+    small.removeRange(2, 5);
+    small.shrinkToFit();
+    EXPECT_TRUE(small.isInline());
+    EXPECT_EQ(small.getCapacity(), 4u);
+    EXPECT_EQ(small[1]->points()[0], Point<int>(1,0));
+
+    Array<int> plain;
+    plain.reserve(100);
+    plain.add(1);
+    plain.shrinkToFit();
+    EXPECT_EQ(plain.getCapacity(), 1u);
+    plain.clear();
+    plain.shrinkToFit();
+    EXPECT_EQ(plain.getCapacity(), 0u);
+    EXPECT_EQ(plain.data(), nullptr);
+    EXPECT_EQ(plain.memoryUsage().bytesReserved, 0u);
+    plain.add(2);
+    EXPECT_EQ(plain[0], 2);
+}
+
+TEST(SmallArrayTest, GrowthPolicy) {
+    Array<int, 0, GrowHalf> half;
+    Array<int> twice;
+    std::vector<size_t> halfCaps, twiceCaps;
+    for (int i = 0; i < 20; ++i) {
+        half.add(i);
+        twice.add(i);
+        if (halfCaps.empty() || halfCaps.back() != half.getCapacity())
+            halfCaps.push_back(half.getCapacity());
+        if (twiceCaps.empty() || twiceCaps.back() != twice.getCapacity())
+            twiceCaps.push_back(twice.getCapacity());
+    }
+    EXPECT_EQ(halfCaps, (std::vector<size_t>{2, 3, 4, 6, 9, 13, 19, 28}));
+    EXPECT_EQ(twiceCaps, (std::vector<size_t>{2, 4, 8, 16, 32}));
+    for (int i = 0; i < 20; ++i)
+        EXPECT_EQ(half[i], i);
+}
+
+TEST(SmallArrayTest, WorksWithAlgorithms) {
+    Array<Rhombus<int>, 8, GrowHalf> arr;
+    for (int s : {3, 1, 2}) {
+        arr.add(Rhombus<int>(Point<int>(0,s), Point<int>(s,0), Point<int>(2*s,s), Point<int>(s,2*s)));
+    }
+    sortBy(arr);
+    EXPECT_TRUE(arr.isInline());
+    EXPECT_EQ(double(arr[0]), 2.0);
+    EXPECT_EQ(double(arr[2]), 18.0);
+    EXPECT_EQ(overlappingPairs(arr).size(), 3u);
+}
+
+// ================== AFFINE ==================
+TEST(AffineTest, ComposeAndDeterminant) {
+    auto m = AffineTransform::scale(2.0, 3.0).then(AffineTransform::translate(1.0, -1.0));
+    EXPECT_EQ(m.apply(Point<double>(1.0, 1.0)), Point<double>(3.0, 2.0));
+    EXPECT_DOUBLE_EQ(m.det(), 6.0);
+
+    auto r = AffineTransform::rotate(std::acos(-1.0) / 2, Point<double>(1.0, 1.0));
+    Point<double> q = r.apply(Point<double>(2.0, 1.0));
+    EXPECT_NEAR(q.x(), 1.0, 1e-12);
+    EXPECT_NEAR(q.y(), 2.0, 1e-12);
+    EXPECT_NEAR(r.det(), 1.0, 1e-12);
+}
+
+TEST(AffineTest, CacheUpdatedAnalytically) {
+    std::array<Point<double>,5> pts{{{0,0}, {4,0}, {5,3}, {2,5}, {-1,3}}};
+    const double original = double(Pentagon<double>(pts));
+
+    // |det| = 1.5, and a reflection with det = -2.5.
+    auto rotated = AffineTransform::rotate(0.7, Point<double>(1.0, 2.0));
+    for (auto m : {rotated.then(AffineTransform::scale(3.0, 0.5)).then(AffineTransform::translate(-3.0, 10.0)),
+                   rotated.then(AffineTransform::scale(-2.5, 1.0)).then(AffineTransform::translate(4.0, -1.0))}) {
+        Pentagon<double> p(pts);
+        ASSERT_EQ(double(p), original);
+        EXPECT_TRUE(p.isCached());
+
+        p.transform(m);
+        EXPECT_TRUE(p.isCached());
+        EXPECT_NEAR(std::abs(m.det()), m.det() > 0 ? 1.5 : 2.5, 1e-12);
+
+        std::array<Point<double>,5> moved;
+        for (size_t i = 0; i < 5; ++i)
+            moved[i] = m.apply(pts[i]);
+        Pentagon<double> fresh(moved);
+
+        for (size_t i = 0; i < 5; ++i) {
+            EXPECT_NEAR(p.points()[i].x(), moved[i].x(), 1e-12);
+            EXPECT_NEAR(p.points()[i].y(), moved[i].y(), 1e-12);
+        }
+        EXPECT_NEAR(double(p), std::abs(m.det()) * original, 1e-9);
+        EXPECT_NEAR(double(p), double(fresh), 1e-9);
+        EXPECT_NEAR(p.center().x(), fresh.center().x(), 1e-9);
+        EXPECT_NEAR(p.center().y(), fresh.center().y(), 1e-9);
+        EXPECT_NEAR(p.boundingBox().min.x(), fresh.boundingBox().min.x(), 1e-12);
+        EXPECT_NEAR(p.boundingBox().max.y(), fresh.boundingBox().max.y(), 1e-12);
+    }
+}
+
+TEST(AffineTest, IntegerVerticesRounded) {
+    Rhombus<int> r(Point<int>(0,1), Point<int>(1,0), Point<int>(2,1), Point<int>(1,2));
+    EXPECT_EQ(double(r), 2.0);
+
+    r.transform(AffineTransform::scale(3.0, 3.0).then(AffineTransform::translate(0.4, -0.6)));
+    EXPECT_FALSE(r.isCached());
+    EXPECT_EQ(r.points()[0], Point<int>(0,2));
+    EXPECT_EQ(r.points()[2], Point<int>(6,2));
+    EXPECT_EQ(double(r), 18.0);
+}
+
+TEST(AffineTest, BatchMatchesPerFigure) {
+    auto arr = makeScatter(10000);
+    auto copy = makeScatter(10000);
+    auto m = AffineTransform::rotate(-1.3, Point<double>(50.0, 50.0)).then(AffineTransform::translate(5.0, 0.25));
+
+    transformAll(arr, m, 3);
+    for (size_t i = 0; i < copy.getSize(); ++i) {
+        copy[i].transform(m);
+        ASSERT_TRUE(arr[i] == copy[i]);
+    }
+
+    Array<std::shared_ptr<Figure<int>>> squares = makeSquares(100);
+    double before = 0.0;
+    for (size_t i = 0; i < squares.getSize(); ++i)
+        before += double(*squares[i]);
+    transformAll(squares, AffineTransform::translate(-7.0, 3.0), 2);
+    double after = 0.0;
+    for (size_t i = 0; i < squares.getSize(); ++i)
+        after += double(*squares[i]);
+    EXPECT_EQ(after, before);
+}
+
+TEST(AffineTest, SharedFiguresTransformedOnce) {
+    std::vector<std::shared_ptr<Figure<double>>> figs;
+    for (int k = 0; k < 7; ++k)
+        figs.push_back(std::make_shared<Rhombus<double>>(
+            Point<double>(k, 1), Point<double>(k + 1, 0), Point<double>(k + 2, 1), Point<double>(k + 1, 2)));
+
+    // Every figure is referenced from many elements spread over all blocks.
+    Array<std::shared_ptr<Figure<double>>> arr;
+    for (size_t i = 0; i < 20000; ++i)
+        arr.add(figs[i % figs.size()]);
+
+    transformAll(arr, AffineTransform::translate(1.0, -2.0), 3);
+    for (size_t k = 0; k < figs.size(); ++k) {
+        EXPECT_EQ(figs[k]->points()[0], Point<double>(k + 1.0, -1.0));
+        EXPECT_EQ(figs[k]->center(), Point<double>(k + 2.0, -1.0));
+    }
+}
+
 // ================== MAIN ==================
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);